@@ -0,0 +1,109 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Benchmark.h"
+
+#include "Clock.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace taste {
+namespace benchmarks {
+namespace {
+void
+write_values(std::ostream& stream, const std::vector<Report::Value>& values)
+{
+    // values round-trip exactly, JSON has no representation of infinities and NaN
+    const std::streamsize precision = stream.precision(std::numeric_limits<double>::max_digits10);
+    stream << "{";
+    for(size_t i = 0; i < values.size(); ++i) {
+        stream << (i == 0 ? "" : ", ") << "\"" << values[i].first << "\": ";
+        if(std::isfinite(values[i].second)) {
+            stream << values[i].second;
+        } else {
+            stream << "null";
+        }
+    }
+    stream << "}";
+    stream.precision(precision);
+}
+
+uint64_t
+percentile(const std::vector<uint64_t>& sorted_samples, double fraction)
+{
+    const size_t index = static_cast<size_t>(fraction * static_cast<double>(sorted_samples.size() - 1));
+    return sorted_samples[index];
+}
+} // namespace
+
+void
+Report::add(const std::string& name, const std::vector<Value>& parameters, const std::vector<Value>& metrics)
+{
+    m_results.push_back(Result{ name, parameters, metrics });
+}
+
+void
+Report::write_json(std::ostream& stream) const
+{
+    stream << "{" << std::endl;
+    stream << "  \"clock\": \"" << (Clock::is_tsc_used() ? "tsc" : "monotonic") << "\"," << std::endl;
+    stream << "  \"benchmarks\": [" << std::endl;
+    for(size_t i = 0; i < m_results.size(); ++i) {
+        stream << "    {\"name\": \"" << m_results[i].name << "\", \"parameters\": ";
+        write_values(stream, m_results[i].parameters);
+        stream << ", \"metrics\": ";
+        write_values(stream, m_results[i].metrics);
+        stream << "}" << (i + 1 == m_results.size() ? "" : ",") << std::endl;
+    }
+    stream << "  ]" << std::endl;
+    stream << "}" << std::endl;
+}
+
+std::vector<Report::Value>
+distribution(const std::string& prefix, std::vector<uint64_t>& samples)
+{
+    if(samples.empty()) {
+        return {};
+    }
+
+    std::sort(samples.begin(), samples.end());
+    const double sum = std::accumulate(samples.begin(), samples.end(), 0.0);
+
+    return { { prefix + "_min", static_cast<double>(samples.front()) },
+             { prefix + "_mean", sum / static_cast<double>(samples.size()) },
+             { prefix + "_p50", static_cast<double>(percentile(samples, 0.5)) },
+             { prefix + "_p90", static_cast<double>(percentile(samples, 0.9)) },
+             { prefix + "_p99", static_cast<double>(percentile(samples, 0.99)) },
+             { prefix + "_p999", static_cast<double>(percentile(samples, 0.999)) },
+             { prefix + "_max", static_cast<double>(samples.back()) } };
+}
+
+uint64_t
+now_ns()
+{
+    return Clock::now_ns();
+}
+} // namespace benchmarks
+} // namespace taste
@@ -0,0 +1,105 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_BENCHMARK_H
+#define TASTE_BENCHMARK_H
+
+/**
+ * @file    Benchmark.h
+ * @brief   Minimal benchmark harness with JSON output.
+ */
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace taste {
+namespace benchmarks {
+/**
+ * @brief Results of benchmarks, written as JSON document.
+ */
+class Report final
+{
+  public:
+    /// Named numeric value
+    using Value = std::pair<std::string, double>;
+
+    /**
+     * @brief Add result of single benchmark.
+     *
+     * @param name          name of the benchmark
+     * @param parameters    parameters of the benchmark
+     * @param metrics       measured values
+     */
+    void add(const std::string& name, const std::vector<Value>& parameters, const std::vector<Value>& metrics);
+
+    /**
+     * @brief Write all results.
+     *
+     * @param stream   output stream
+     */
+    void write_json(std::ostream& stream) const;
+
+  private:
+    struct Result
+    {
+        std::string name;
+        std::vector<Value> parameters;
+        std::vector<Value> metrics;
+    };
+
+    std::vector<Result> m_results;
+};
+
+/**
+ * @brief Compute distribution metrics of samples.
+ *
+ * @param prefix    prefix of metric names, e.g. "latency_ns"
+ * @param samples   samples, will be sorted
+ *
+ * @return min, mean, p50, p90, p99, p99.9 and max values
+ */
+std::vector<Report::Value> distribution(const std::string& prefix, std::vector<uint64_t>& samples);
+
+/**
+ * @brief Get current time.
+ *
+ * @return current time in nanoseconds
+ */
+uint64_t now_ns();
+
+/// @brief Run Queue benchmarks
+void run_queue_benchmarks(Report& report);
+/// @brief Run Lock and BrokerLock benchmarks
+void run_lock_benchmarks(Report& report);
+/// @brief Run Hal benchmarks
+void run_hal_benchmarks(Report& report);
+/// @brief Run Timer benchmarks
+void run_timer_benchmarks(Report& report);
+/// @brief Run DatagramLink benchmarks over loopback
+void run_link_benchmarks(Report& report);
+} // namespace benchmarks
+} // namespace taste
+
+#endif
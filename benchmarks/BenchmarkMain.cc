@@ -0,0 +1,47 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Benchmark.h"
+
+#include <fstream>
+#include <iostream>
+
+int
+main(int argc, char* argv[])
+{
+    taste::benchmarks::Report report;
+
+    taste::benchmarks::run_hal_benchmarks(report);
+    taste::benchmarks::run_timer_benchmarks(report);
+    taste::benchmarks::run_lock_benchmarks(report);
+    taste::benchmarks::run_queue_benchmarks(report);
+    taste::benchmarks::run_link_benchmarks(report);
+
+    if(argc > 1) {
+        std::ofstream output(argv[1]);
+        report.write_json(output);
+    } else {
+        report.write_json(std::cout);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,64 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Benchmark.h"
+
+#include "Hal.h"
+
+#include <vector>
+
+namespace taste {
+namespace benchmarks {
+namespace {
+constexpr size_t ELAPSED_TIME_ITERATIONS = 10000000;
+constexpr size_t SLEEP_ITERATIONS = 500;
+constexpr uint64_t SLEEP_TIME_NS = 1000000;
+} // namespace
+
+void
+run_hal_benchmarks(Report& report)
+{
+    Hal_Init();
+
+    volatile uint64_t sink = 0;
+    const uint64_t start_time = now_ns();
+    for(size_t i = 0; i < ELAPSED_TIME_ITERATIONS; ++i) {
+        sink = Hal_GetElapsedTimeInNs();
+    }
+    const uint64_t elapsed_time = now_ns() - start_time;
+    (void)sink;
+    report.add("hal_get_elapsed_time",
+               {},
+               { { "ns_per_call", static_cast<double>(elapsed_time) / static_cast<double>(ELAPSED_TIME_ITERATIONS) } });
+
+    std::vector<uint64_t> oversleep;
+    oversleep.reserve(SLEEP_ITERATIONS);
+    for(size_t i = 0; i < SLEEP_ITERATIONS; ++i) {
+        const uint64_t sleep_start = Hal_GetElapsedTimeInNs();
+        Hal_SleepNs(SLEEP_TIME_NS);
+        const uint64_t sleep_time = Hal_GetElapsedTimeInNs() - sleep_start;
+        oversleep.push_back(sleep_time > SLEEP_TIME_NS ? sleep_time - SLEEP_TIME_NS : 0);
+    }
+    report.add("hal_sleep_jitter", { { "sleep_ns", SLEEP_TIME_NS } }, distribution("oversleep_ns", oversleep));
+}
+} // namespace benchmarks
+} // namespace taste
@@ -0,0 +1,153 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Benchmark.h"
+
+#ifdef RT_SINGLE_THREADED
+#include <iostream>
+
+namespace taste {
+namespace benchmarks {
+void
+run_link_benchmarks(Report& report)
+{
+    // DatagramLink runs its own sender and receiver threads
+    (void)report;
+    std::cerr << "Link benchmarks skipped, not available in single-threaded build" << std::endl;
+}
+} // namespace benchmarks
+} // namespace taste
+#else
+#include "DatagramLink.h"
+#include "DatagramSocket.h"
+#include "Queue.h"
+#include "Semaphore.h"
+
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace taste {
+namespace benchmarks {
+namespace {
+constexpr size_t PARAMETER_SIZE = 256;
+constexpr size_t QUEUE_CAPACITY = 256;
+constexpr size_t MESSAGES = 100000;
+constexpr int LINK_PRIORITY = 1;
+constexpr size_t LINK_STACK_SIZE = 1 << 16;
+constexpr uint32_t CHANNEL = 1;
+constexpr uint16_t UDP_LOCAL_PORT = 47810;
+constexpr uint16_t UDP_REMOTE_PORT = 47811;
+
+using LinkQueue = Queue<PARAMETER_SIZE>;
+using Link = DatagramLink<PARAMETER_SIZE>;
+
+bool
+real_time_priority_permitted()
+{
+    rlimit limit;
+    return geteuid() == 0 || (getrlimit(RLIMIT_RTPRIO, &limit) == 0 && limit.rlim_cur >= LINK_PRIORITY);
+}
+
+/// Requests travel over loopback from the outbound queue of one link to the inbound queue
+/// of the other one. Producer is throttled by credits, so the socket buffers do not overflow.
+void
+link_throughput(Report& report, const char* name, DatagramSocket& local_socket, DatagramSocket& remote_socket)
+{
+    // link threads never end, so the sockets, links and queues are never destroyed
+    LinkQueue* const outbound = new LinkQueue(QUEUE_CAPACITY, "outbound");
+    LinkQueue* const inbound = new LinkQueue(QUEUE_CAPACITY, "inbound");
+    Link* const local_link = new Link(local_socket, LINK_PRIORITY, LINK_STACK_SIZE, "local-link");
+    Link* const remote_link = new Link(remote_socket, LINK_PRIORITY, LINK_STACK_SIZE, "remote-link");
+    local_link->add_outbound(CHANNEL, *outbound);
+    remote_link->add_inbound(CHANNEL, *inbound);
+    local_link->start();
+    remote_link->start();
+
+    Semaphore credits(QUEUE_CAPACITY);
+    std::vector<uint64_t> latencies;
+    latencies.reserve(MESSAGES);
+
+    const uint64_t start_time = now_ns();
+    std::thread producer([outbound, &credits]() {
+        std::array<uint8_t, PARAMETER_SIZE> payload{};
+        for(size_t i = 0; i < MESSAGES; ++i) {
+            credits.obtain();
+            const uint64_t timestamp = now_ns();
+            memcpy(payload.data(), &timestamp, sizeof(timestamp));
+            outbound->put(PID_producer_1, payload.data(), PARAMETER_SIZE);
+        }
+    });
+
+    std::unique_ptr<Request<PARAMETER_SIZE>> request(new Request<PARAMETER_SIZE>());
+    for(size_t i = 0; i < MESSAGES; ++i) {
+        inbound->get(*request);
+        uint64_t timestamp;
+        memcpy(&timestamp, request->data(), sizeof(timestamp));
+        latencies.push_back(now_ns() - timestamp);
+        credits.release();
+    }
+    const uint64_t elapsed_time = now_ns() - start_time;
+    producer.join();
+
+    std::vector<Report::Value> metrics = distribution("latency_ns", latencies);
+    metrics.emplace_back("messages_per_second",
+                         static_cast<double>(MESSAGES) * 1e9 / static_cast<double>(elapsed_time));
+    metrics.emplace_back("requests_per_packet",
+                         static_cast<double>(local_link->sent_requests())
+                                 / static_cast<double>(local_link->sent_packets()));
+    report.add(name, { { "parameter_size", PARAMETER_SIZE }, { "packet_size", RT_LINK_MAX_PACKET_SIZE } }, metrics);
+}
+} // namespace
+
+void
+run_link_benchmarks(Report& report)
+{
+    if(!real_time_priority_permitted()) {
+        std::cerr << "Link benchmarks skipped, real-time priorities are not permitted" << std::endl;
+        return;
+    }
+
+    link_throughput(report,
+                    "link_udp",
+                    *new DatagramSocket("127.0.0.1", UDP_LOCAL_PORT, "127.0.0.1", UDP_REMOTE_PORT),
+                    *new DatagramSocket("127.0.0.1", UDP_REMOTE_PORT, "127.0.0.1", UDP_LOCAL_PORT));
+
+    const std::string local_path = "/tmp/taste-link-local-" + std::to_string(getpid());
+    const std::string remote_path = "/tmp/taste-link-remote-" + std::to_string(getpid());
+    link_throughput(report,
+                    "link_unix",
+                    *new DatagramSocket(local_path.c_str(), remote_path.c_str()),
+                    *new DatagramSocket(remote_path.c_str(), local_path.c_str()));
+    unlink(local_path.c_str());
+    unlink(remote_path.c_str());
+}
+} // namespace benchmarks
+} // namespace taste
+#endif
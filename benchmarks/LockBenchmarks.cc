@@ -0,0 +1,141 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Benchmark.h"
+
+#include "BrokerLock.h"
+#include "Lock.h"
+
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace taste {
+namespace benchmarks {
+namespace {
+constexpr size_t UNCONTENDED_ITERATIONS = 5000000;
+#ifndef RT_SINGLE_THREADED
+constexpr size_t CONTENDED_ITERATIONS = 500000;
+#endif
+
+const char*
+policy_name(Lock::Policy policy)
+{
+    switch(policy) {
+        case Lock::Policy::PriorityInheritance:
+            return "priority_inheritance";
+        case Lock::Policy::PriorityCeiling:
+            return "priority_ceiling";
+        case Lock::Policy::AdaptiveSpin:
+            return "adaptive_spin";
+        case Lock::Policy::None:
+            break;
+    }
+    return "none";
+}
+
+/// Runs operation in given number of threads, returns operations per second
+double
+run_in_threads(size_t thread_count, size_t iterations, const std::function<void(size_t)>& operation)
+{
+    const uint64_t start_time = now_ns();
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back([&operation, iterations, i]() {
+            for(size_t j = 0; j < iterations; ++j) {
+                operation(i);
+            }
+        });
+    }
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+    const uint64_t elapsed_time = now_ns() - start_time;
+
+    return static_cast<double>(thread_count * iterations) * 1e9 / static_cast<double>(elapsed_time);
+}
+
+void
+lock_benchmarks(Report& report, Lock::Policy policy)
+{
+    Lock lock(policy);
+    volatile uint64_t counter = 0;
+    const auto operation = [&lock, &counter](size_t) {
+        lock.lock();
+        counter = counter + 1;
+        lock.unlock();
+    };
+
+    const double uncontended = run_in_threads(1, UNCONTENDED_ITERATIONS, operation);
+    report.add("lock_uncontended",
+               { { std::string("policy_") + policy_name(policy), 1 } },
+               { { "ns_per_operation", 1e9 / uncontended } });
+
+#ifndef RT_SINGLE_THREADED
+    for(const size_t threads : { size_t(2), size_t(4) }) {
+        const double contended = run_in_threads(threads, CONTENDED_ITERATIONS, operation);
+        report.add("lock_contended",
+                   { { std::string("policy_") + policy_name(policy), 1 }, { "threads", static_cast<double>(threads) } },
+                   { { "operations_per_second", contended } });
+    }
+#endif
+}
+
+void
+broker_lock_benchmarks(Report& report)
+{
+    const auto global = [](size_t) {
+        Broker_acquire_lock();
+        Broker_release_lock();
+    };
+    const auto per_destination = [](size_t destination) {
+        Broker_acquire_lock_for(static_cast<uint32_t>(destination));
+        Broker_release_lock_for(static_cast<uint32_t>(destination));
+    };
+
+    report.add("broker_lock_uncontended",
+               { { "per_destination", 0 } },
+               { { "ns_per_operation", 1e9 / run_in_threads(1, UNCONTENDED_ITERATIONS, global) } });
+    report.add("broker_lock_uncontended",
+               { { "per_destination", 1 } },
+               { { "ns_per_operation", 1e9 / run_in_threads(1, UNCONTENDED_ITERATIONS, per_destination) } });
+#ifndef RT_SINGLE_THREADED
+    report.add("broker_lock_contended",
+               { { "per_destination", 0 }, { "threads", 4 } },
+               { { "operations_per_second", run_in_threads(4, CONTENDED_ITERATIONS, global) } });
+    report.add("broker_lock_contended",
+               { { "per_destination", 1 }, { "threads", 4 } },
+               { { "operations_per_second", run_in_threads(4, CONTENDED_ITERATIONS, per_destination) } });
+#endif
+}
+} // namespace
+
+void
+run_lock_benchmarks(Report& report)
+{
+    lock_benchmarks(report, Lock::Policy::None);
+    lock_benchmarks(report, Lock::Policy::PriorityInheritance);
+    lock_benchmarks(report, Lock::Policy::AdaptiveSpin);
+    broker_lock_benchmarks(report);
+}
+} // namespace benchmarks
+} // namespace taste
@@ -0,0 +1,250 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Benchmark.h"
+
+#include "Queue.h"
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#ifndef RT_SINGLE_THREADED
+#include "Semaphore.h"
+
+#include <thread>
+#endif
+
+namespace taste {
+namespace benchmarks {
+namespace {
+constexpr size_t QUEUE_CAPACITY = 256;
+constexpr size_t SINGLE_THREAD_BATCHES = 1000;
+
+/// Cost of put and get called from one thread, e.g. to compare builds with and without RT_SINGLE_THREADED
+template<size_t PARAMETER_SIZE>
+void
+queue_single_thread(Report& report)
+{
+    Queue<PARAMETER_SIZE> queue(QUEUE_CAPACITY, "single_thread");
+    std::array<uint8_t, PARAMETER_SIZE> payload{};
+    std::unique_ptr<Request<PARAMETER_SIZE>> request(new Request<PARAMETER_SIZE>());
+    uint64_t put_time = 0;
+    uint64_t get_time = 0;
+    for(size_t i = 0; i < SINGLE_THREAD_BATCHES; ++i) {
+        const uint64_t put_start_time = now_ns();
+        for(size_t j = 0; j < QUEUE_CAPACITY; ++j) {
+            queue.put(PID_producer_1, payload.data(), PARAMETER_SIZE);
+        }
+        const uint64_t get_start_time = now_ns();
+        for(size_t j = 0; j < QUEUE_CAPACITY; ++j) {
+            queue.get(*request);
+        }
+        get_time += now_ns() - get_start_time;
+        put_time += get_start_time - put_start_time;
+    }
+
+    const double operations = static_cast<double>(SINGLE_THREAD_BATCHES * QUEUE_CAPACITY);
+    report.add("queue_single_thread",
+               { { "parameter_size", PARAMETER_SIZE }, { "capacity", QUEUE_CAPACITY } },
+               { { "put_ns", static_cast<double>(put_time) / operations },
+                 { "get_ns", static_cast<double>(get_time) / operations } });
+}
+
+#ifndef RT_SINGLE_THREADED
+constexpr size_t THROUGHPUT_MESSAGES = 200000;
+constexpr size_t ROUND_TRIPS = 20000;
+constexpr size_t CHAIN_HOPS = 5;
+
+template<size_t PARAMETER_SIZE>
+void
+write_timestamp(std::array<uint8_t, PARAMETER_SIZE>& payload, uint64_t timestamp)
+{
+    static_assert(PARAMETER_SIZE >= sizeof(uint64_t), "payload shall fit a timestamp");
+    memcpy(payload.data(), &timestamp, sizeof(timestamp));
+}
+
+template<size_t PARAMETER_SIZE>
+uint64_t
+read_timestamp(const Request<PARAMETER_SIZE>& request)
+{
+    uint64_t timestamp;
+    memcpy(&timestamp, request.data(), sizeof(timestamp));
+    return timestamp;
+}
+
+/// Producers are throttled by credits, so the queue never drops messages
+template<size_t PARAMETER_SIZE>
+void
+queue_throughput(Report& report, const char* name, size_t producers)
+{
+    Queue<PARAMETER_SIZE> queue(QUEUE_CAPACITY, name);
+    Semaphore credits(QUEUE_CAPACITY);
+    const size_t messages_per_producer = THROUGHPUT_MESSAGES / producers;
+    const size_t messages = messages_per_producer * producers;
+    std::vector<uint64_t> latencies;
+    latencies.reserve(messages);
+
+    const uint64_t start_time = now_ns();
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < producers; ++i) {
+        const asn1SccPID sender = static_cast<asn1SccPID>(PID_producer_1 + static_cast<int>(i));
+        threads.emplace_back([&queue, &credits, messages_per_producer, sender]() {
+            std::array<uint8_t, PARAMETER_SIZE> payload{};
+            for(size_t j = 0; j < messages_per_producer; ++j) {
+                credits.obtain();
+                write_timestamp(payload, now_ns());
+                queue.put(sender, payload.data(), PARAMETER_SIZE);
+            }
+        });
+    }
+
+    std::unique_ptr<Request<PARAMETER_SIZE>> request(new Request<PARAMETER_SIZE>());
+    for(size_t i = 0; i < messages; ++i) {
+        queue.get(*request);
+        latencies.push_back(now_ns() - read_timestamp(*request));
+        credits.release();
+    }
+    const uint64_t elapsed_time = now_ns() - start_time;
+
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<Report::Value> metrics = distribution("latency_ns", latencies);
+    metrics.emplace_back("messages_per_second",
+                         static_cast<double>(messages) * 1e9 / static_cast<double>(elapsed_time));
+    report.add(name,
+               { { "parameter_size", PARAMETER_SIZE },
+                 { "producers", static_cast<double>(producers) },
+                 { "capacity", QUEUE_CAPACITY } },
+               metrics);
+}
+
+/// One-way latency of request/response through idle consumer
+template<size_t PARAMETER_SIZE>
+void
+queue_round_trip(Report& report, bool direct_handoff)
+{
+    Queue<PARAMETER_SIZE> requests(QUEUE_CAPACITY, "requests");
+    Queue<PARAMETER_SIZE> responses(QUEUE_CAPACITY, "responses");
+    requests.set_direct_handoff(direct_handoff);
+    responses.set_direct_handoff(direct_handoff);
+    std::vector<uint64_t> latencies;
+    latencies.reserve(ROUND_TRIPS);
+
+    std::thread responder([&requests, &responses]() {
+        std::unique_ptr<Request<PARAMETER_SIZE>> request(new Request<PARAMETER_SIZE>());
+        for(size_t i = 0; i < ROUND_TRIPS; ++i) {
+            requests.get(*request);
+            request->set_sender_pid(PID_consumer);
+            responses.put(*request);
+        }
+    });
+
+    std::array<uint8_t, PARAMETER_SIZE> payload{};
+    std::unique_ptr<Request<PARAMETER_SIZE>> response(new Request<PARAMETER_SIZE>());
+    for(size_t i = 0; i < ROUND_TRIPS; ++i) {
+        const uint64_t start_time = now_ns();
+        requests.put(PID_producer_1, payload.data(), PARAMETER_SIZE);
+        responses.get(*response);
+        latencies.push_back((now_ns() - start_time) / 2);
+    }
+    responder.join();
+
+    report.add("queue_round_trip",
+               { { "parameter_size", PARAMETER_SIZE }, { "direct_handoff", direct_handoff ? 1.0 : 0.0 } },
+               distribution("one_way_ns", latencies));
+}
+
+/// End-to-end latency of request passed through a chain of idle consumers
+template<size_t PARAMETER_SIZE>
+void
+queue_chain(Report& report, bool direct_handoff)
+{
+    std::vector<std::unique_ptr<Queue<PARAMETER_SIZE>>> queues;
+    for(size_t i = 0; i <= CHAIN_HOPS; ++i) {
+        queues.emplace_back(new Queue<PARAMETER_SIZE>(QUEUE_CAPACITY, "chain"));
+        queues.back()->set_direct_handoff(direct_handoff);
+    }
+    std::vector<uint64_t> latencies;
+    latencies.reserve(ROUND_TRIPS);
+
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < CHAIN_HOPS; ++i) {
+        threads.emplace_back([&queues, i]() {
+            std::unique_ptr<Request<PARAMETER_SIZE>> request(new Request<PARAMETER_SIZE>());
+            for(size_t j = 0; j < ROUND_TRIPS; ++j) {
+                queues[i]->get(*request);
+                request->set_sender_pid(PID_consumer);
+                queues[i + 1]->put(*request);
+            }
+        });
+    }
+
+    std::array<uint8_t, PARAMETER_SIZE> payload{};
+    std::unique_ptr<Request<PARAMETER_SIZE>> response(new Request<PARAMETER_SIZE>());
+    for(size_t i = 0; i < ROUND_TRIPS; ++i) {
+        const uint64_t start_time = now_ns();
+        queues.front()->put(PID_producer_1, payload.data(), PARAMETER_SIZE);
+        queues.back()->get(*response);
+        latencies.push_back(now_ns() - start_time);
+    }
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+
+    report.add("queue_chain",
+               { { "parameter_size", PARAMETER_SIZE },
+                 { "hops", CHAIN_HOPS },
+                 { "direct_handoff", direct_handoff ? 1.0 : 0.0 } },
+               distribution("end_to_end_ns", latencies));
+}
+#endif
+
+template<size_t PARAMETER_SIZE>
+void
+run_for_size(Report& report)
+{
+    queue_single_thread<PARAMETER_SIZE>(report);
+#ifndef RT_SINGLE_THREADED
+    // the remaining benchmarks pass requests between threads
+    queue_throughput<PARAMETER_SIZE>(report, "queue_spsc", 1);
+    queue_throughput<PARAMETER_SIZE>(report, "queue_mpsc", 4);
+    for(const bool direct_handoff : { false, true }) {
+        queue_round_trip<PARAMETER_SIZE>(report, direct_handoff);
+        queue_chain<PARAMETER_SIZE>(report, direct_handoff);
+    }
+#endif
+}
+} // namespace
+
+void
+run_queue_benchmarks(Report& report)
+{
+    run_for_size<8>(report);
+    run_for_size<256>(report);
+    run_for_size<4096>(report);
+}
+} // namespace benchmarks
+} // namespace taste
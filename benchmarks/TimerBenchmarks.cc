@@ -0,0 +1,78 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Benchmark.h"
+
+#include "Clock.h"
+#include "Timer.h"
+
+#include <vector>
+
+namespace taste {
+namespace benchmarks {
+namespace {
+constexpr size_t ACTIVATIONS = 500;
+constexpr std::chrono::milliseconds PERIOD(1);
+constexpr std::chrono::milliseconds START_DELAY(10);
+
+/// Thrown by the callback to leave Timer::run, which never returns
+struct TimerFinished
+{
+};
+} // namespace
+
+void
+run_timer_benchmarks(Report& report)
+{
+    Timer::initialize();
+
+    std::vector<uint64_t> lateness;
+    lateness.reserve(ACTIVATIONS);
+    // the epoch may have been established earlier by Hal_Init,
+    // so the dispatch offset is computed from the current time
+    const std::chrono::milliseconds dispatch_offset =
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::nanoseconds(Clock::elapsed_ns()))
+            + START_DELAY;
+    const uint64_t period_ns =
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(PERIOD).count());
+    uint64_t expected_time = Clock::epoch_ns()
+                             + static_cast<uint64_t>(
+                                     std::chrono::duration_cast<std::chrono::nanoseconds>(dispatch_offset).count());
+
+    try {
+        Timer::run(dispatch_offset, PERIOD, [&lateness, &expected_time, period_ns]() {
+            const uint64_t now = Clock::now_ns();
+            lateness.push_back(now > expected_time ? now - expected_time : 0);
+            expected_time += period_ns;
+            if(lateness.size() == ACTIVATIONS) {
+                throw TimerFinished();
+            }
+        });
+    } catch(const TimerFinished&) {
+    }
+
+    report.add("timer_wake_jitter",
+               { { "period_ns", static_cast<double>(period_ns) } },
+               distribution("lateness_ns", lateness));
+}
+} // namespace benchmarks
+} // namespace taste
@@ -0,0 +1,41 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DATAVIEW_UNIQ_H
+#define DATAVIEW_UNIQ_H
+
+/**
+ * @file    dataview-uniq.h
+ * @brief   Stub of generated dataview used to build benchmarks without a TASTE model.
+ */
+
+typedef enum
+{
+    PID_env = 0,
+    PID_producer_1 = 1,
+    PID_producer_2 = 2,
+    PID_producer_3 = 3,
+    PID_producer_4 = 4,
+    PID_consumer = 5
+} asn1SccPID;
+
+#endif
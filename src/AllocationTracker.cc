@@ -0,0 +1,181 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AllocationTracker.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+#include <execinfo.h>
+#include <unistd.h>
+
+namespace taste {
+namespace {
+/// Prevents recursion when reporting itself allocates memory
+__attribute__((tls_model("initial-exec"))) thread_local bool in_allocation_hook = false;
+} // namespace
+
+void
+AllocationTracker::arm()
+{
+    static std::once_flag at_exit_flag;
+    std::call_once(at_exit_flag, []() {
+        // the first backtrace loads the unwinder, which allocates
+        void* frames[1];
+        backtrace(frames, 1);
+        atexit([]() {
+            disarm();
+            print_summary();
+        });
+    });
+
+    m_armed.store(true, std::memory_order_release);
+}
+
+void
+AllocationTracker::disarm()
+{
+    m_armed.store(false, std::memory_order_release);
+}
+
+bool
+AllocationTracker::is_armed()
+{
+    return m_armed.load(std::memory_order_acquire);
+}
+
+uint64_t
+AllocationTracker::allocation_count()
+{
+    return m_allocation_count.load(std::memory_order_relaxed);
+}
+
+void
+AllocationTracker::record_allocation(size_t size)
+{
+    if(!m_armed.load(std::memory_order_relaxed) || in_allocation_hook) {
+        return;
+    }
+    in_allocation_hook = true;
+
+    const uint64_t count = m_allocation_count.fetch_add(1, std::memory_order_relaxed) + 1;
+    if(count <= RT_ALLOCATION_TRACKER_MAX_REPORTS) {
+        report(size, count);
+    }
+#ifdef RT_ALLOCATION_TRACKER_ABORT
+    abort();
+#endif
+
+    in_allocation_hook = false;
+}
+
+void
+AllocationTracker::report(size_t size, uint64_t count)
+{
+    // std::cerr is not used, as it may allocate
+    char message[128];
+    const int length = snprintf(message,
+                                sizeof(message),
+                                "Memory allocation of %zu bytes after startup (%llu):\n",
+                                size,
+                                static_cast<unsigned long long>(count));
+    if(length > 0 && write(STDERR_FILENO, message, static_cast<size_t>(length)) < 0) {
+        return;
+    }
+
+    void* frames[RT_ALLOCATION_TRACKER_BACKTRACE_DEPTH];
+    const int depth = backtrace(frames, RT_ALLOCATION_TRACKER_BACKTRACE_DEPTH);
+    // the first frames are the tracker itself
+    constexpr int SKIPPED_FRAMES = 3;
+    if(depth > SKIPPED_FRAMES) {
+        backtrace_symbols_fd(frames + SKIPPED_FRAMES, depth - SKIPPED_FRAMES, STDERR_FILENO);
+    }
+}
+
+void
+AllocationTracker::print_summary()
+{
+    const uint64_t count = allocation_count();
+    if(count != 0) {
+        std::cerr << count << " memory allocations after startup" << std::endl;
+    }
+}
+
+std::atomic<bool> AllocationTracker::m_armed(false);
+std::atomic<uint64_t> AllocationTracker::m_allocation_count(0);
+} // namespace taste
+
+#ifdef RT_ALLOCATION_TRACKER
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void*
+malloc(size_t size) noexcept
+{
+    taste::AllocationTracker::record_allocation(size);
+    return __libc_malloc(size);
+}
+
+void*
+calloc(size_t count, size_t size) noexcept
+{
+    taste::AllocationTracker::record_allocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void*
+realloc(void* pointer, size_t size) noexcept
+{
+    taste::AllocationTracker::record_allocation(size);
+    return __libc_realloc(pointer, size);
+}
+
+void*
+aligned_alloc(size_t alignment, size_t size) noexcept
+{
+    taste::AllocationTracker::record_allocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+int
+posix_memalign(void** pointer, size_t alignment, size_t size) noexcept
+{
+    taste::AllocationTracker::record_allocation(size);
+    if(alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    void* memory = __libc_memalign(alignment, size);
+    if(memory == nullptr) {
+        return ENOMEM;
+    }
+    *pointer = memory;
+    return 0;
+}
+}
+#endif
@@ -0,0 +1,109 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_ALLOCATION_TRACKER_H
+#define TASTE_ALLOCATION_TRACKER_H
+
+/**
+ * @file    AllocationTracker.h
+ * @brief   Detection of memory allocations in the steady state.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef RT_ALLOCATION_TRACKER_MAX_REPORTS
+#define RT_ALLOCATION_TRACKER_MAX_REPORTS 16
+#endif
+
+#ifndef RT_ALLOCATION_TRACKER_BACKTRACE_DEPTH
+#define RT_ALLOCATION_TRACKER_BACKTRACE_DEPTH 32
+#endif
+
+namespace taste {
+/**
+ * @brief Tracker of memory allocations done after the startup.
+ *
+ * If RT_ALLOCATION_TRACKER is defined, malloc, calloc, realloc and aligned
+ * allocation functions are replaced by counting wrappers of glibc allocator.
+ * The default operator new uses malloc, so it is counted as well.
+ * When the tracker is armed, every allocation is counted and first
+ * RT_ALLOCATION_TRACKER_MAX_REPORTS allocations are reported on the standard
+ * error together with a backtrace. If RT_ALLOCATION_TRACKER_ABORT is defined,
+ * the first allocation aborts the process instead.
+ *
+ * The tracker is armed by StartBarrier after the initialization is finished,
+ * and disarmed at exit.
+ */
+class AllocationTracker final
+{
+  public:
+    /**
+     * @brief Deleted default constructor.
+     */
+    AllocationTracker() = delete;
+
+    /**
+     * @brief Start tracking allocations.
+     */
+    static void arm();
+
+    /**
+     * @brief Stop tracking allocations.
+     */
+    static void disarm();
+
+    /**
+     * @brief Check if tracking is enabled.
+     *
+     * @return true if allocations are tracked, otherwise false
+     */
+    static bool is_armed();
+
+    /**
+     * @brief Get number of allocations done while the tracker was armed.
+     *
+     * @return number of allocations
+     */
+    static uint64_t allocation_count();
+
+    /**
+     * @brief Record an allocation.
+     *
+     * Called by allocation function wrappers. Shall not allocate memory.
+     *
+     * @param size  size of the allocation in bytes
+     */
+    static void record_allocation(size_t size);
+
+  private:
+    static void report(size_t size, uint64_t count);
+    static void print_summary();
+
+  private:
+    static std::atomic<bool> m_armed;
+    static std::atomic<uint64_t> m_allocation_count;
+};
+} // namespace taste
+
+#endif
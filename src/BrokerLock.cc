@@ -24,13 +24,58 @@
 
 #include "Lock.h"
 
+#include <cstddef>
+
+#ifdef RT_SINGLE_THREADED
+// Broker is called only by the partition thread, there is nothing to protect
+extern "C"
+{
+    void Broker_acquire_lock() {}
+
+    void Broker_release_lock() {}
+
+    void Broker_acquire_lock_for(uint32_t destination) { (void)destination; }
+
+    void Broker_release_lock_for(uint32_t destination) { (void)destination; }
+}
+#else
 namespace {
-taste::Lock broker_lock;
+/// Stripes are aligned to separate cache lines to avoid false sharing
+struct alignas(64) BrokerLockStripe
+{
+    taste::Lock lock{ "broker", taste::Lock::Policy::RT_BROKER_LOCK_POLICY, RT_BROKER_LOCK_PRIORITY_CEILING };
+};
+
+static_assert(RT_BROKER_LOCK_STRIPES > 0, "RT_BROKER_LOCK_STRIPES shall be positive");
+
+BrokerLockStripe broker_lock_stripes[RT_BROKER_LOCK_STRIPES];
+
+taste::Lock&
+broker_lock_for(uint32_t destination)
+{
+    return broker_lock_stripes[destination % RT_BROKER_LOCK_STRIPES].lock;
 }
+} // namespace
 
 extern "C"
 {
-    void Broker_acquire_lock() { broker_lock.lock(); }
+    void Broker_acquire_lock()
+    {
+        // stripes are always acquired in the same order to avoid deadlocks
+        for(size_t i = 0; i < RT_BROKER_LOCK_STRIPES; ++i) {
+            broker_lock_stripes[i].lock.lock();
+        }
+    }
+
+    void Broker_release_lock()
+    {
+        for(size_t i = RT_BROKER_LOCK_STRIPES; i > 0; --i) {
+            broker_lock_stripes[i - 1].lock.unlock();
+        }
+    }
+
+    void Broker_acquire_lock_for(uint32_t destination) { broker_lock_for(destination).lock(); }
 
-    void Broker_release_lock() { broker_lock.unlock(); }
+    void Broker_release_lock_for(uint32_t destination) { broker_lock_for(destination).unlock(); }
 }
+#endif
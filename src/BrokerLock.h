@@ -29,14 +29,55 @@
  *
  * Broker is runtime-agnostic, therefore these functions are implemented by
  * runtime with c-linkage.
+ *
+ * The broker state is protected by RT_BROKER_LOCK_STRIPES independent locks.
+ * Messages routed to different destinations can use different stripes,
+ * so they do not contend with each other. The global lock acquires all stripes
+ * and is kept for compatibility with brokers which do not route per destination.
+ * The global lock costs one lock operation per stripe, so there is a single
+ * stripe by default. With a single stripe, the per-destination functions
+ * take the same lock as the global one, so they bring no benefit. They help
+ * only when RT_BROKER_LOCK_STRIPES is above 1, which configurations using
+ * per-destination routing should set, e.g. to the number of destinations,
+ * using the TASTE_RUNTIME_BROKER_LOCK_STRIPES CMake cache variable.
  */
 
+#include <stdint.h>
+
+/// Number of independent broker locks, per-destination locking helps only if it is above 1
+#ifndef RT_BROKER_LOCK_STRIPES
+#define RT_BROKER_LOCK_STRIPES 1
+#endif
+
+/// Policy of broker locks, name of taste::Lock::Policy enumerator
+#ifndef RT_BROKER_LOCK_POLICY
+#define RT_BROKER_LOCK_POLICY RT_DEFAULT_LOCK_POLICY
+#endif
+
+/// Priority ceiling of broker locks with PriorityCeiling policy
+#ifndef RT_BROKER_LOCK_PRIORITY_CEILING
+#define RT_BROKER_LOCK_PRIORITY_CEILING RT_DEFAULT_LOCK_PRIORITY_CEILING
+#endif
+
 extern "C"
 {
     /// @brief function used by Broker to acquire the lock.
     void Broker_acquire_lock();
     /// @brief function used by Broker to release the lock.
     void Broker_release_lock();
+
+    /**
+     * @brief function used by Broker to acquire the lock for single destination.
+     *
+     * @param destination   identifier of the destination (e.g. PID or queue index)
+     */
+    void Broker_acquire_lock_for(uint32_t destination);
+    /**
+     * @brief function used by Broker to release the lock for single destination.
+     *
+     * @param destination   identifier passed to Broker_acquire_lock_for
+     */
+    void Broker_release_lock_for(uint32_t destination);
 }
 
 #endif
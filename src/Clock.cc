@@ -0,0 +1,208 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Clock.h"
+
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#ifdef RT_TSC_CLOCK_AVAILABLE
+#include <cpuid.h>
+#endif
+
+namespace taste {
+namespace {
+std::once_flag clock_initialization_flag;
+}
+
+void
+Clock::initialize()
+{
+    std::call_once(clock_initialization_flag, []() {
+#ifdef RT_TSC_CLOCK_AVAILABLE
+        if(is_tsc_invariant()) {
+            calibrate();
+            start_maintenance();
+        }
+#endif
+        m_epoch_ns.store(now_ns(), std::memory_order_relaxed);
+    });
+}
+
+void
+Clock::synchronize()
+{
+#ifdef RT_TSC_CLOCK_AVAILABLE
+    if(!m_tsc_used.load(std::memory_order_relaxed)
+       || m_resync_in_progress.exchange(true, std::memory_order_acquire)) {
+        return;
+    }
+
+    // the parameters are updated only by the thread holding m_resync_in_progress
+    const Parameters& published = m_parameters[m_published_parameters.load(std::memory_order_relaxed)];
+    const uint64_t base_tsc = published.base_tsc.load(std::memory_order_relaxed);
+    const uint64_t monotonic_ns = read_monotonic_ns();
+    const uint64_t current_tsc = __rdtsc();
+    if(!is_resync_due(current_tsc, base_tsc)) {
+        m_resync_in_progress.store(false, std::memory_order_release);
+        return;
+    }
+    const uint64_t estimated_ns = convert(current_tsc,
+                                          base_tsc,
+                                          published.base_ns.load(std::memory_order_relaxed),
+                                          published.multiplier.load(std::memory_order_relaxed),
+                                          published.rate_multiplier.load(std::memory_order_relaxed));
+
+    // The rate is computed over the whole interval since the previous reference point.
+    const uint64_t rate_multiplier = static_cast<uint64_t>(
+            (static_cast<uint128_t>(monotonic_ns - m_reference_ns) << MULTIPLIER_SHIFT)
+            / (current_tsc - m_reference_tsc));
+    m_reference_tsc = current_tsc;
+    m_reference_ns = monotonic_ns;
+
+    // The new base continues from the estimate, so the clock does not jump, and the offset
+    // from CLOCK_MONOTONIC is slewed out over the next interval. The correction is limited
+    // to half of the interval, so the clock keeps advancing.
+    const int64_t interval_ns = static_cast<int64_t>(
+            (static_cast<uint128_t>(m_resync_interval_cycles) * rate_multiplier) >> MULTIPLIER_SHIFT);
+    int64_t offset_ns = static_cast<int64_t>(monotonic_ns - estimated_ns);
+    if(offset_ns > interval_ns / 2) {
+        offset_ns = interval_ns / 2;
+    } else if(offset_ns < -interval_ns / 2) {
+        offset_ns = -interval_ns / 2;
+    }
+    const uint64_t multiplier = static_cast<uint64_t>(
+            (static_cast<uint128_t>(interval_ns + offset_ns) << MULTIPLIER_SHIFT) / m_resync_interval_cycles);
+
+    publish(current_tsc, estimated_ns, multiplier, rate_multiplier);
+    m_resync_in_progress.store(false, std::memory_order_release);
+#endif
+}
+
+bool
+Clock::is_tsc_used()
+{
+#ifdef RT_TSC_CLOCK_AVAILABLE
+    return m_tsc_used.load(std::memory_order_relaxed);
+#else
+    return false;
+#endif
+}
+
+#ifdef RT_TSC_CLOCK_AVAILABLE
+bool
+Clock::is_tsc_invariant()
+{
+    unsigned int eax = 0;
+    unsigned int ebx = 0;
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+    if(__get_cpuid(0x80000000U, &eax, &ebx, &ecx, &edx) == 0 || eax < 0x80000007U) {
+        return false;
+    }
+    __get_cpuid(0x80000007U, &eax, &ebx, &ecx, &edx);
+    const unsigned int invariant_tsc_bit = 1U << 8U;
+    if((edx & invariant_tsc_bit) == 0) {
+        return false;
+    }
+
+    // The kernel marks TSC as unstable (e.g. unsynchronized between sockets)
+    // by switching to a different clocksource.
+    std::ifstream clocksource("/sys/devices/system/clocksource/clocksource0/current_clocksource");
+    std::string name;
+    return clocksource >> name && name == "tsc";
+}
+
+void
+Clock::calibrate()
+{
+    const uint64_t start_ns = read_monotonic_ns();
+    const uint64_t start_tsc = __rdtsc();
+    uint64_t end_ns = start_ns;
+    uint64_t end_tsc = start_tsc;
+    while(end_ns - start_ns < RT_TSC_CALIBRATION_NS) {
+        end_ns = read_monotonic_ns();
+        end_tsc = __rdtsc();
+    }
+    if(end_tsc <= start_tsc) {
+        return;
+    }
+
+    const uint64_t multiplier = static_cast<uint64_t>(
+            (static_cast<uint128_t>(end_ns - start_ns) << MULTIPLIER_SHIFT) / (end_tsc - start_tsc));
+    m_resync_interval_cycles = static_cast<uint64_t>(
+            (static_cast<uint128_t>(RT_TSC_RESYNC_INTERVAL_NS) * (end_tsc - start_tsc)) / (end_ns - start_ns));
+    m_reference_tsc = end_tsc;
+    m_reference_ns = end_ns;
+
+    publish(end_tsc, end_ns, multiplier, multiplier);
+    m_tsc_used.store(true, std::memory_order_release);
+}
+
+void
+Clock::start_maintenance()
+{
+#ifdef RT_SINGLE_THREADED
+    // no other thread may run, the Hal sleep functions re-synchronize the clock
+#else
+    // the clock is checked a few times per interval, so it is re-synchronized soon after it is due
+    std::thread maintenance([]() {
+        while(true) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(RT_TSC_RESYNC_INTERVAL_NS / 4));
+            synchronize();
+        }
+    });
+    maintenance.detach();
+#endif
+}
+
+
+void
+Clock::publish(uint64_t base_tsc, uint64_t base_ns, uint64_t multiplier, uint64_t rate_multiplier)
+{
+    // readers use the published block, so the other one is updated and then published
+    const uint32_t next = m_published_parameters.load(std::memory_order_relaxed) ^ 1U;
+    Parameters& parameters = m_parameters[next];
+    parameters.sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    parameters.base_tsc.store(base_tsc, std::memory_order_relaxed);
+    parameters.base_ns.store(base_ns, std::memory_order_relaxed);
+    parameters.multiplier.store(multiplier, std::memory_order_relaxed);
+    parameters.rate_multiplier.store(rate_multiplier, std::memory_order_relaxed);
+    parameters.sequence.fetch_add(1, std::memory_order_release);
+    m_published_parameters.store(next, std::memory_order_release);
+}
+
+std::atomic<bool> Clock::m_tsc_used(false);
+std::atomic<bool> Clock::m_resync_in_progress(false);
+Clock::Parameters Clock::m_parameters[2] = {};
+std::atomic<uint32_t> Clock::m_published_parameters(0);
+uint64_t Clock::m_resync_interval_cycles = 0;
+uint64_t Clock::m_reference_tsc = 0;
+uint64_t Clock::m_reference_ns = 0;
+#endif
+
+std::atomic<uint64_t> Clock::m_epoch_ns(0);
+} // namespace taste
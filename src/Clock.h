@@ -0,0 +1,249 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_CLOCK_H
+#define TASTE_CLOCK_H
+
+/**
+ * @file    Clock.h
+ * @brief   Monotonic time base shared by Hal and Timer.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <time.h>
+
+#if defined(RT_USE_TSC_CLOCK) && (defined(__x86_64__) || defined(__i386__))
+#define RT_TSC_CLOCK_AVAILABLE 1
+#include <x86intrin.h>
+#endif
+
+#ifndef RT_TSC_CALIBRATION_NS
+#define RT_TSC_CALIBRATION_NS 10000000ULL
+#endif
+
+#ifndef RT_TSC_RESYNC_INTERVAL_NS
+#define RT_TSC_RESYNC_INTERVAL_NS 1000000000ULL
+#endif
+
+namespace taste {
+/**
+ * @brief Monotonic clock used as the single time base of the runtime.
+ *
+ * The returned time is expressed in the CLOCK_MONOTONIC domain, so it can be
+ * used directly with clock_nanosleep and std::chrono::steady_clock.
+ *
+ * When RT_USE_TSC_CLOCK is defined and the CPU provides an invariant TSC,
+ * the time is computed from the TSC, calibrated against CLOCK_MONOTONIC
+ * during initialization and re-synchronized every RT_TSC_RESYNC_INTERVAL_NS.
+ * The offset from CLOCK_MONOTONIC found at re-synchronization is not applied
+ * as a step, it is slewed out over the next interval, so the clock stays
+ * continuous and follows CLOCK_MONOTONIC. The time returned to a thread never
+ * goes backwards, even if it read the parameters just replaced by
+ * the re-synchronization.
+ *
+ * Reading the time does not re-synchronize the clock. This is done by
+ * a maintenance thread started by initialize, or in single-threaded build,
+ * by the Hal sleep functions before they sleep. If the clock is not
+ * re-synchronized in time, it keeps advancing at the measured TSC rate.
+ * The parameters are kept in two blocks, the one being updated is not
+ * the one published, so readers never wait for a preempted thread.
+ * When the TSC is not used, CLOCK_MONOTONIC is read directly.
+ */
+class Clock final
+{
+  public:
+    /// @brief deleted default constructor
+    Clock() = delete;
+
+    /**
+     * @brief Initialize the clock.
+     *
+     * The first call establishes the epoch of the runtime, subsequent calls
+     * have no effect. This shall be called before starting threads.
+     */
+    static void initialize();
+
+    /**
+     * @brief Re-synchronize the TSC with CLOCK_MONOTONIC, if it is due.
+     *
+     * This is done only if RT_TSC_RESYNC_INTERVAL_NS elapsed since the previous
+     * re-synchronization, and it has no effect if the TSC is not used.
+     */
+    static void synchronize();
+
+    /**
+     * @brief Get current time.
+     *
+     * @return current CLOCK_MONOTONIC time in nanoseconds
+     */
+    static uint64_t now_ns();
+
+    /**
+     * @brief Get the epoch of the runtime.
+     *
+     * @return CLOCK_MONOTONIC time of the initialization in nanoseconds
+     */
+    static uint64_t epoch_ns();
+
+    /**
+     * @brief Get time elapsed from the epoch of the runtime.
+     *
+     * @return elapsed time in nanoseconds
+     */
+    static uint64_t elapsed_ns();
+
+    /**
+     * @brief Check which clock source is used.
+     *
+     * @return true if the TSC is used, false if CLOCK_MONOTONIC is used
+     */
+    static bool is_tsc_used();
+
+  private:
+    static uint64_t read_monotonic_ns();
+
+#ifdef RT_TSC_CLOCK_AVAILABLE
+    /// Parameters of the conversion from TSC, a published block is not modified
+    struct Parameters
+    {
+        std::atomic<uint32_t> sequence;
+        std::atomic<uint64_t> base_tsc;
+        std::atomic<uint64_t> base_ns;
+        /// Multiplier including the slew, used for the first resync interval after the base
+        std::atomic<uint64_t> multiplier;
+        /// Multiplier of the measured TSC rate, used after the first resync interval
+        std::atomic<uint64_t> rate_multiplier;
+    };
+
+    static bool is_tsc_invariant();
+    static void calibrate();
+    static void start_maintenance();
+    static void publish(uint64_t base_tsc, uint64_t base_ns, uint64_t multiplier, uint64_t rate_multiplier);
+    static uint64_t convert(uint64_t tsc,
+                            uint64_t base_tsc,
+                            uint64_t base_ns,
+                            uint64_t multiplier,
+                            uint64_t rate_multiplier);
+    static bool is_resync_due(uint64_t tsc, uint64_t base_tsc);
+
+    __extension__ typedef unsigned __int128 uint128_t;
+
+    static constexpr unsigned int MULTIPLIER_SHIFT = 32;
+
+    static std::atomic<bool> m_tsc_used;
+    static std::atomic<bool> m_resync_in_progress;
+    static Parameters m_parameters[2];
+    static std::atomic<uint32_t> m_published_parameters;
+    /// Time last returned to the thread, so it does not go backwards when the parameters change
+    inline static thread_local uint64_t m_last_ns = 0;
+    static uint64_t m_resync_interval_cycles;
+    static uint64_t m_reference_tsc;
+    static uint64_t m_reference_ns;
+#endif
+
+    static std::atomic<uint64_t> m_epoch_ns;
+};
+
+inline uint64_t
+Clock::read_monotonic_ns()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+}
+
+#ifdef RT_TSC_CLOCK_AVAILABLE
+inline uint64_t
+Clock::convert(uint64_t tsc, uint64_t base_tsc, uint64_t base_ns, uint64_t multiplier, uint64_t rate_multiplier)
+{
+    const uint64_t delta = tsc > base_tsc ? tsc - base_tsc : 0;
+    if(delta <= m_resync_interval_cycles) {
+        return base_ns + static_cast<uint64_t>((static_cast<uint128_t>(delta) * multiplier) >> MULTIPLIER_SHIFT);
+    }
+    // the slew is complete after one interval, the rest advances at the measured rate
+    const uint128_t slewed = static_cast<uint128_t>(m_resync_interval_cycles) * multiplier;
+    const uint128_t remaining = static_cast<uint128_t>(delta - m_resync_interval_cycles) * rate_multiplier;
+    return base_ns + static_cast<uint64_t>((slewed + remaining) >> MULTIPLIER_SHIFT);
+}
+
+inline bool
+Clock::is_resync_due(uint64_t tsc, uint64_t base_tsc)
+{
+    // TSC of another CPU may be slightly behind the base, which is not an elapsed interval
+    return tsc > base_tsc && tsc - base_tsc > m_resync_interval_cycles;
+}
+
+inline uint64_t
+Clock::now_ns()
+{
+    if(!m_tsc_used.load(std::memory_order_relaxed)) {
+        return read_monotonic_ns();
+    }
+
+    // Only the block which is not published is updated, so the read is repeated
+    // only if this thread was stalled for a whole resync interval while reading.
+    while(true) {
+        const Parameters& parameters = m_parameters[m_published_parameters.load(std::memory_order_acquire)];
+        const uint32_t sequence = parameters.sequence.load(std::memory_order_acquire);
+        const uint64_t base_tsc = parameters.base_tsc.load(std::memory_order_relaxed);
+        const uint64_t base_ns = parameters.base_ns.load(std::memory_order_relaxed);
+        const uint64_t multiplier = parameters.multiplier.load(std::memory_order_relaxed);
+        const uint64_t rate_multiplier = parameters.rate_multiplier.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if((sequence & 1U) != 0 || parameters.sequence.load(std::memory_order_relaxed) != sequence) {
+            continue;
+        }
+
+        const uint64_t now = convert(__rdtsc(), base_tsc, base_ns, multiplier, rate_multiplier);
+        if(now < m_last_ns) {
+            // the parameters were replaced after this thread read the previous ones
+            return m_last_ns;
+        }
+        m_last_ns = now;
+        return now;
+    }
+}
+#else
+inline uint64_t
+Clock::now_ns()
+{
+    return read_monotonic_ns();
+}
+#endif
+
+inline uint64_t
+Clock::epoch_ns()
+{
+    return m_epoch_ns.load(std::memory_order_relaxed);
+}
+
+inline uint64_t
+Clock::elapsed_ns()
+{
+    const uint64_t now = now_ns();
+    const uint64_t epoch = epoch_ns();
+    return now > epoch ? now - epoch : 0;
+}
+} // namespace taste
+
+#endif
@@ -0,0 +1,513 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_DATAGRAM_LINK_H
+#define TASTE_DATAGRAM_LINK_H
+
+/**
+ * @file    DatagramLink.h
+ * @brief   Transport of queued requests between nodes over datagram sockets.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "DatagramSocket.h"
+#include "Queue.h"
+#include "Request.h"
+#include "Thread.h"
+
+#ifdef RT_SINGLE_THREADED
+#error "DatagramLink requires multiple threads and cannot be used in single-threaded build"
+#endif
+
+/// Maximum size of packet coalescing many requests, larger requests are sent in a packet of their own
+#ifndef RT_LINK_MAX_PACKET_SIZE
+#define RT_LINK_MAX_PACKET_SIZE 1472
+#endif
+
+/// Maximum number of requests taken from outbound queue and sent using one system call
+#ifndef RT_LINK_SEND_BATCH_SIZE
+#define RT_LINK_SEND_BATCH_SIZE 64
+#endif
+
+/// Maximum number of packets received using one system call
+#ifndef RT_LINK_RECEIVE_BATCH_SIZE
+#define RT_LINK_RECEIVE_BATCH_SIZE 16
+#endif
+
+/// Number of channels, channel identifiers shall be lower
+#ifndef RT_LINK_MAX_CHANNELS
+#define RT_LINK_MAX_CHANNELS 64
+#endif
+
+namespace taste {
+/**
+ * @brief Link between partitions on different nodes.
+ *
+ * Each outbound queue is drained by its own sender thread. The thread
+ * waits for a request, then takes all requests available without waiting,
+ * up to RT_LINK_SEND_BATCH_SIZE, coalesces them into packets of at most
+ * RT_LINK_MAX_PACKET_SIZE bytes and sends all packets using one system
+ * call. Packets are gathered directly from the taken requests, without
+ * copying them into a packet buffer.
+ *
+ * The receiver thread receives up to RT_LINK_RECEIVE_BATCH_SIZE packets
+ * using one system call and puts each request directly into the inbound
+ * queue of its channel, with the original sender PID.
+ *
+ * Packet consists of a header and frames, each frame carries one request:
+ *
+ *    packet: magic (4 bytes), frame count (4 bytes), frames
+ *    frame:  channel (4 bytes), sender PID (4 bytes), length (4 bytes), data
+ *
+ * All integers are in network byte order. The channel identifies the
+ * destination queue on the receiving node. Packets which do not fit the
+ * format, and requests for unknown channels, are counted and dropped.
+ * Requests dropped by full inbound queues are counted separately.
+ *
+ * Link threads do not take part in StartBarrier, queues shall be
+ * added before the link is started.
+ *
+ * @tparam PARAMETER_SIZE The maximum size of single request in bytes.
+ */
+template<size_t PARAMETER_SIZE>
+class DatagramLink final
+{
+  public:
+    /**
+     * @brief Constructor
+     *
+     * @param socket        Socket connecting to the peer node
+     * @param priority      Priority of link threads
+     * @param stack_size    Stack size of link threads in bytes
+     * @param name          Name of link threads, may be nullptr
+     */
+    DatagramLink(DatagramSocket& socket, int priority, size_t stack_size, const char* name = nullptr);
+
+    /// @brief deleted copy constructor
+    DatagramLink(const DatagramLink&) = delete;
+
+    /// @brief deleted move constructor
+    DatagramLink(DatagramLink&&) = delete;
+
+    /// @brief deleted copy assignment operator
+    DatagramLink& operator=(const DatagramLink&) = delete;
+
+    /// @brief deleted move assignment operator
+    DatagramLink& operator=(DatagramLink&&) = delete;
+
+    /**
+     * @brief Send requests from the queue to the channel of the peer
+     *
+     * @param channel       channel on the peer node
+     * @param queue         outbound queue
+     */
+    void add_outbound(uint32_t channel, Queue<PARAMETER_SIZE>& queue);
+
+    /**
+     * @brief Put requests received on the channel into the queue
+     *
+     * @param channel       channel on this node
+     * @param queue         inbound queue
+     */
+    void add_inbound(uint32_t channel, Queue<PARAMETER_SIZE>& queue);
+
+    /**
+     * @brief Start sender and receiver threads
+     *
+     * Threads run until the program ends.
+     */
+    void start();
+
+    /**
+     * @brief Get the number of requests passed to the socket
+     *
+     * @return number of sent requests
+     */
+    uint64_t sent_requests() const;
+
+    /**
+     * @brief Get the number of packets passed to the socket
+     *
+     * @return number of sent packets
+     */
+    uint64_t sent_packets() const;
+
+    /**
+     * @brief Get the number of requests put into inbound queues
+     *
+     * @return number of received requests
+     */
+    uint64_t received_requests() const;
+
+    /**
+     * @brief Get the number of received packets
+     *
+     * @return number of received packets
+     */
+    uint64_t received_packets() const;
+
+    /**
+     * @brief Get the number of received requests which were rejected
+     *
+     * @return number of malformed requests and requests for unknown channels
+     */
+    uint64_t rejected_requests() const;
+
+    /**
+     * @brief Get the number of received requests which were dropped by full inbound queues
+     *
+     * @return number of requests dropped by the inbound queues
+     */
+    uint64_t dropped_requests() const;
+
+  private:
+    struct PacketHeader
+    {
+        uint32_t magic;
+        uint32_t frame_count;
+    };
+
+    struct FrameHeader
+    {
+        uint32_t channel;
+        uint32_t sender_pid;
+        uint32_t length;
+    };
+
+    /// State of the sender thread of one outbound queue
+    struct Outbound
+    {
+        DatagramLink* link;
+        uint32_t channel;
+        Queue<PARAMETER_SIZE>* queue;
+        std::unique_ptr<Thread> thread;
+        std::unique_ptr<Request<PARAMETER_SIZE>[]> requests;
+        std::unique_ptr<FrameHeader[]> frame_headers;
+        std::unique_ptr<PacketHeader[]> packet_headers;
+        std::unique_ptr<iovec[]> vectors;
+        std::unique_ptr<mmsghdr[]> messages;
+    };
+
+    static constexpr uint32_t PACKET_MAGIC = 0x54534c4b; // "TSLK"
+    static constexpr size_t PACKET_BUFFER_SIZE =
+            std::max<size_t>(RT_LINK_MAX_PACKET_SIZE, sizeof(PacketHeader) + sizeof(FrameHeader) + PARAMETER_SIZE);
+
+    static void sender(void* param);
+    static void receiver(void* param);
+    static size_t pack(Outbound& outbound, size_t request_count);
+    void unpack(const uint8_t* packet, size_t size);
+    static void check_channel(uint32_t channel);
+
+  private:
+    DatagramSocket& m_socket;
+    const int m_priority;
+    const size_t m_stack_size;
+    const char* const m_name;
+    std::vector<std::unique_ptr<Outbound>> m_outbound;
+    Queue<PARAMETER_SIZE>* m_inbound[RT_LINK_MAX_CHANNELS];
+    std::unique_ptr<Thread> m_receiver;
+    std::unique_ptr<uint8_t[]> m_receive_buffer;
+    std::unique_ptr<iovec[]> m_receive_vectors;
+    std::unique_ptr<mmsghdr[]> m_receive_messages;
+
+    std::atomic<uint64_t> m_sent_requests;
+    std::atomic<uint64_t> m_sent_packets;
+    std::atomic<uint64_t> m_received_requests;
+    std::atomic<uint64_t> m_received_packets;
+    std::atomic<uint64_t> m_rejected_requests;
+    std::atomic<uint64_t> m_dropped_requests;
+};
+
+template<size_t PARAMETER_SIZE>
+DatagramLink<PARAMETER_SIZE>::DatagramLink(DatagramSocket& socket, int priority, size_t stack_size, const char* name)
+    : m_socket(socket)
+    , m_priority(priority)
+    , m_stack_size(stack_size)
+    , m_name(name)
+    , m_inbound()
+    , m_receiver(new Thread(priority, stack_size, name))
+    , m_receive_buffer(new uint8_t[RT_LINK_RECEIVE_BATCH_SIZE * PACKET_BUFFER_SIZE])
+    , m_receive_vectors(new iovec[RT_LINK_RECEIVE_BATCH_SIZE])
+    , m_receive_messages(new mmsghdr[RT_LINK_RECEIVE_BATCH_SIZE])
+    , m_sent_requests(0)
+    , m_sent_packets(0)
+    , m_received_requests(0)
+    , m_received_packets(0)
+    , m_rejected_requests(0)
+    , m_dropped_requests(0)
+{
+    memset(m_receive_messages.get(), 0, RT_LINK_RECEIVE_BATCH_SIZE * sizeof(mmsghdr));
+    for(size_t i = 0; i < RT_LINK_RECEIVE_BATCH_SIZE; ++i) {
+        m_receive_vectors[i].iov_base = m_receive_buffer.get() + i * PACKET_BUFFER_SIZE;
+        m_receive_vectors[i].iov_len = PACKET_BUFFER_SIZE;
+        m_receive_messages[i].msg_hdr.msg_iov = &m_receive_vectors[i];
+        m_receive_messages[i].msg_hdr.msg_iovlen = 1;
+    }
+}
+
+template<size_t PARAMETER_SIZE>
+void
+DatagramLink<PARAMETER_SIZE>::add_outbound(uint32_t channel, Queue<PARAMETER_SIZE>& queue)
+{
+    check_channel(channel);
+
+    // every request may start a new packet, each packet has a header vector
+    // and each request has a frame header vector and data vector
+    std::unique_ptr<Outbound> outbound(new Outbound());
+    outbound->link = this;
+    outbound->channel = channel;
+    outbound->queue = &queue;
+    outbound->thread.reset(new Thread(m_priority, m_stack_size, m_name));
+    outbound->requests.reset(new Request<PARAMETER_SIZE>[RT_LINK_SEND_BATCH_SIZE]);
+    outbound->frame_headers.reset(new FrameHeader[RT_LINK_SEND_BATCH_SIZE]);
+    outbound->packet_headers.reset(new PacketHeader[RT_LINK_SEND_BATCH_SIZE]);
+    outbound->vectors.reset(new iovec[3 * RT_LINK_SEND_BATCH_SIZE]);
+    outbound->messages.reset(new mmsghdr[RT_LINK_SEND_BATCH_SIZE]);
+    m_outbound.push_back(std::move(outbound));
+}
+
+template<size_t PARAMETER_SIZE>
+void
+DatagramLink<PARAMETER_SIZE>::add_inbound(uint32_t channel, Queue<PARAMETER_SIZE>& queue)
+{
+    check_channel(channel);
+    m_inbound[channel] = &queue;
+}
+
+template<size_t PARAMETER_SIZE>
+void
+DatagramLink<PARAMETER_SIZE>::start()
+{
+    for(std::unique_ptr<Outbound>& outbound : m_outbound) {
+        outbound->thread->start(&DatagramLink::sender, outbound.get());
+    }
+    m_receiver->start(&DatagramLink::receiver, this);
+}
+
+template<size_t PARAMETER_SIZE>
+uint64_t
+DatagramLink<PARAMETER_SIZE>::sent_requests() const
+{
+    return m_sent_requests.load(std::memory_order_relaxed);
+}
+
+template<size_t PARAMETER_SIZE>
+uint64_t
+DatagramLink<PARAMETER_SIZE>::sent_packets() const
+{
+    return m_sent_packets.load(std::memory_order_relaxed);
+}
+
+template<size_t PARAMETER_SIZE>
+uint64_t
+DatagramLink<PARAMETER_SIZE>::received_requests() const
+{
+    return m_received_requests.load(std::memory_order_relaxed);
+}
+
+template<size_t PARAMETER_SIZE>
+uint64_t
+DatagramLink<PARAMETER_SIZE>::received_packets() const
+{
+    return m_received_packets.load(std::memory_order_relaxed);
+}
+
+template<size_t PARAMETER_SIZE>
+uint64_t
+DatagramLink<PARAMETER_SIZE>::rejected_requests() const
+{
+    return m_rejected_requests.load(std::memory_order_relaxed);
+}
+
+template<size_t PARAMETER_SIZE>
+uint64_t
+DatagramLink<PARAMETER_SIZE>::dropped_requests() const
+{
+    return m_dropped_requests.load(std::memory_order_relaxed);
+}
+
+template<size_t PARAMETER_SIZE>
+void
+DatagramLink<PARAMETER_SIZE>::sender(void* param)
+{
+    Outbound& outbound = *static_cast<Outbound*>(param);
+    DatagramLink& link = *outbound.link;
+
+    while(true) {
+        outbound.queue->get(outbound.requests[0]);
+        size_t request_count = 1;
+        while(request_count < RT_LINK_SEND_BATCH_SIZE && outbound.queue->try_get(outbound.requests[request_count])) {
+            ++request_count;
+        }
+
+        const size_t packet_count = pack(outbound, request_count);
+        const size_t sent_packets = link.m_socket.send(outbound.messages.get(), packet_count);
+        link.m_sent_packets.fetch_add(sent_packets, std::memory_order_relaxed);
+        if(sent_packets == packet_count) {
+            link.m_sent_requests.fetch_add(request_count, std::memory_order_relaxed);
+        } else {
+            uint64_t sent_requests = 0;
+            for(size_t i = 0; i < packet_count; ++i) {
+                if(outbound.messages[i].msg_len != 0) {
+                    sent_requests += ntohl(outbound.packet_headers[i].frame_count);
+                }
+            }
+            link.m_sent_requests.fetch_add(sent_requests, std::memory_order_relaxed);
+        }
+    }
+}
+
+template<size_t PARAMETER_SIZE>
+void
+DatagramLink<PARAMETER_SIZE>::receiver(void* param)
+{
+    DatagramLink& link = *static_cast<DatagramLink*>(param);
+
+    while(true) {
+        const size_t packet_count = link.m_socket.receive(link.m_receive_messages.get(), RT_LINK_RECEIVE_BATCH_SIZE);
+        link.m_received_packets.fetch_add(packet_count, std::memory_order_relaxed);
+        for(size_t i = 0; i < packet_count; ++i) {
+            const msghdr& header = link.m_receive_messages[i].msg_hdr;
+            if((header.msg_flags & MSG_TRUNC) != 0) {
+                link.m_rejected_requests.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            link.unpack(static_cast<const uint8_t*>(header.msg_iov->iov_base), link.m_receive_messages[i].msg_len);
+        }
+    }
+}
+
+template<size_t PARAMETER_SIZE>
+size_t
+DatagramLink<PARAMETER_SIZE>::pack(Outbound& outbound, size_t request_count)
+{
+    size_t packet = 0;
+    size_t packet_size = 0;
+    size_t vector = 0;
+    memset(outbound.messages.get(), 0, RT_LINK_SEND_BATCH_SIZE * sizeof(mmsghdr));
+
+    for(size_t i = 0; i < request_count; ++i) {
+        const Request<PARAMETER_SIZE>& request = outbound.requests[i];
+        const size_t frame_size = sizeof(FrameHeader) + request.length();
+        if(i == 0 || packet_size + frame_size > RT_LINK_MAX_PACKET_SIZE) {
+            if(i != 0) {
+                ++packet;
+            }
+            outbound.packet_headers[packet].magic = htonl(PACKET_MAGIC);
+            outbound.packet_headers[packet].frame_count = 0;
+            outbound.vectors[vector].iov_base = &outbound.packet_headers[packet];
+            outbound.vectors[vector].iov_len = sizeof(PacketHeader);
+            outbound.messages[packet].msg_hdr.msg_iov = &outbound.vectors[vector];
+            outbound.messages[packet].msg_hdr.msg_iovlen = 1;
+            ++vector;
+            packet_size = sizeof(PacketHeader);
+        }
+
+        FrameHeader& frame_header = outbound.frame_headers[i];
+        frame_header.channel = htonl(outbound.channel);
+        frame_header.sender_pid = htonl(static_cast<uint32_t>(request.sender_pid()));
+        frame_header.length = htonl(static_cast<uint32_t>(request.length()));
+        outbound.vectors[vector].iov_base = &frame_header;
+        outbound.vectors[vector].iov_len = sizeof(FrameHeader);
+        outbound.vectors[vector + 1].iov_base = const_cast<uint8_t*>(request.data());
+        outbound.vectors[vector + 1].iov_len = request.length();
+        vector += 2;
+
+        outbound.messages[packet].msg_hdr.msg_iovlen += 2;
+        ++outbound.packet_headers[packet].frame_count;
+        packet_size += frame_size;
+    }
+
+    for(size_t i = 0; i <= packet; ++i) {
+        outbound.packet_headers[i].frame_count = htonl(outbound.packet_headers[i].frame_count);
+    }
+    return packet + 1;
+}
+
+template<size_t PARAMETER_SIZE>
+void
+DatagramLink<PARAMETER_SIZE>::unpack(const uint8_t* packet, size_t size)
+{
+    PacketHeader packet_header;
+    if(size < sizeof(PacketHeader)) {
+        m_rejected_requests.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    memcpy(&packet_header, packet, sizeof(PacketHeader));
+    if(ntohl(packet_header.magic) != PACKET_MAGIC) {
+        m_rejected_requests.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // headers are copied, as frames are not aligned
+    const uint32_t frame_count = ntohl(packet_header.frame_count);
+    size_t offset = sizeof(PacketHeader);
+    for(uint32_t i = 0; i < frame_count; ++i) {
+        FrameHeader frame_header;
+        if(size - offset < sizeof(FrameHeader)) {
+            m_rejected_requests.fetch_add(frame_count - i, std::memory_order_relaxed);
+            return;
+        }
+        memcpy(&frame_header, packet + offset, sizeof(FrameHeader));
+        offset += sizeof(FrameHeader);
+
+        const uint32_t channel = ntohl(frame_header.channel);
+        const size_t length = ntohl(frame_header.length);
+        if(length > PARAMETER_SIZE || size - offset < length) {
+            m_rejected_requests.fetch_add(frame_count - i, std::memory_order_relaxed);
+            return;
+        }
+        const asn1SccPID sender_pid = static_cast<asn1SccPID>(ntohl(frame_header.sender_pid));
+        if(channel >= RT_LINK_MAX_CHANNELS || m_inbound[channel] == nullptr) {
+            m_rejected_requests.fetch_add(1, std::memory_order_relaxed);
+        } else if(m_inbound[channel]->put(sender_pid, packet + offset, length)) {
+            m_received_requests.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            m_dropped_requests.fetch_add(1, std::memory_order_relaxed);
+        }
+        offset += length;
+    }
+}
+
+template<size_t PARAMETER_SIZE>
+void
+DatagramLink<PARAMETER_SIZE>::check_channel(uint32_t channel)
+{
+    if(channel >= RT_LINK_MAX_CHANNELS) {
+        std::cerr << "Link channel " << channel << " shall be lower than " << RT_LINK_MAX_CHANNELS << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+} // namespace taste
+
+#endif
@@ -0,0 +1,167 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DatagramSocket.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace taste {
+namespace {
+sockaddr_in
+ipv4_address(const char* address, uint16_t port)
+{
+    sockaddr_in result;
+    memset(&result, 0, sizeof(result));
+    result.sin_family = AF_INET;
+    result.sin_port = htons(port);
+    if(inet_pton(AF_INET, address, &result.sin_addr) != 1) {
+        std::cerr << "Invalid IPv4 address '" << address << "'" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return result;
+}
+
+sockaddr_un
+unix_address(const char* path)
+{
+    sockaddr_un result;
+    memset(&result, 0, sizeof(result));
+    result.sun_family = AF_UNIX;
+    if(strlen(path) >= sizeof(result.sun_path)) {
+        std::cerr << "Unix socket path '" << path << "' is too long" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    strncpy(result.sun_path, path, sizeof(result.sun_path) - 1);
+    return result;
+}
+
+int
+open_socket(int domain)
+{
+    const int descriptor = socket(domain, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if(descriptor < 0) {
+        std::cerr << "Unable to create datagram socket. Error code : " << errno << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return descriptor;
+}
+
+void
+bind_to(int descriptor, const sockaddr* address, socklen_t address_length)
+{
+    if(bind(descriptor, address, address_length) != 0) {
+        std::cerr << "Unable to bind datagram socket. Error code : " << errno << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+} // namespace
+
+DatagramSocket::DatagramSocket(const char* local_address,
+                               uint16_t local_port,
+                               const char* peer_address,
+                               uint16_t peer_port)
+    : m_descriptor(open_socket(AF_INET))
+    , m_dropped_datagrams(0)
+{
+    const sockaddr_in local = ipv4_address(local_address, local_port);
+    bind_to(m_descriptor, reinterpret_cast<const sockaddr*>(&local), sizeof(local));
+    const sockaddr_in peer = ipv4_address(peer_address, peer_port);
+    memcpy(&m_peer_address, &peer, sizeof(peer));
+    m_peer_address_length = sizeof(peer);
+}
+
+DatagramSocket::DatagramSocket(const char* local_path, const char* peer_path)
+    : m_descriptor(open_socket(AF_UNIX))
+    , m_local_path(local_path)
+    , m_dropped_datagrams(0)
+{
+    const sockaddr_un local = unix_address(local_path);
+    unlink(local_path);
+    bind_to(m_descriptor, reinterpret_cast<const sockaddr*>(&local), sizeof(local));
+    const sockaddr_un peer = unix_address(peer_path);
+    memcpy(&m_peer_address, &peer, sizeof(peer));
+    m_peer_address_length = sizeof(peer);
+}
+
+DatagramSocket::~DatagramSocket()
+{
+    close(m_descriptor);
+    if(!m_local_path.empty()) {
+        unlink(m_local_path.c_str());
+    }
+}
+
+size_t
+DatagramSocket::send(mmsghdr* messages, size_t count)
+{
+    for(size_t i = 0; i < count; ++i) {
+        messages[i].msg_hdr.msg_name = &m_peer_address;
+        messages[i].msg_hdr.msg_namelen = m_peer_address_length;
+    }
+
+    size_t sent = 0;
+    while(sent < count) {
+        const int result = sendmmsg(m_descriptor, messages + sent, static_cast<unsigned int>(count - sent), 0);
+        if(result > 0) {
+            sent += static_cast<size_t>(result);
+        } else if(result < 0 && errno == EINTR) {
+            continue;
+        } else {
+            // the first datagram could not be sent, e.g. the peer is not bound yet,
+            // it is dropped and the rest of the batch is retried
+            m_dropped_datagrams.fetch_add(1, std::memory_order_relaxed);
+            ++messages;
+            --count;
+        }
+    }
+    return sent;
+}
+
+size_t
+DatagramSocket::receive(mmsghdr* messages, size_t count)
+{
+    while(true) {
+        const int result = recvmmsg(m_descriptor, messages, static_cast<unsigned int>(count), MSG_WAITFORONE, nullptr);
+        if(result > 0) {
+            return static_cast<size_t>(result);
+        }
+        if(result < 0 && errno != EINTR) {
+            std::cerr << "Unable to receive datagrams. Error code : " << errno << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+uint64_t
+DatagramSocket::dropped_datagrams() const
+{
+    return m_dropped_datagrams.load(std::memory_order_relaxed);
+}
+} // namespace taste
@@ -0,0 +1,128 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_DATAGRAM_SOCKET_H
+#define TASTE_DATAGRAM_SOCKET_H
+
+/**
+ * @file    DatagramSocket.h
+ * @brief   UDP or Unix datagram socket with batched transfers.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <sys/socket.h>
+
+namespace taste {
+/**
+ * @brief Datagram socket exchanging datagrams with a single peer.
+ *
+ * Datagrams are sent and received in batches using sendmmsg and recvmmsg,
+ * so a single system call transfers many datagrams. Errors during setup
+ * terminate the program, while datagrams which cannot be sent, e.g.
+ * because the peer is not running yet, are counted and dropped. The peer
+ * does not need to exist when the socket is created.
+ */
+class DatagramSocket final
+{
+  public:
+    /**
+     * @brief Constructor of UDP socket
+     *
+     * @param local_address     IPv4 address to bind to, e.g. "127.0.0.1"
+     * @param local_port        UDP port to bind to
+     * @param peer_address      IPv4 address of the peer
+     * @param peer_port         UDP port of the peer
+     */
+    DatagramSocket(const char* local_address, uint16_t local_port, const char* peer_address, uint16_t peer_port);
+
+    /**
+     * @brief Constructor of Unix datagram socket
+     *
+     * The local path is removed before binding and when the socket is destroyed.
+     *
+     * @param local_path        path to bind to
+     * @param peer_path         path of the peer
+     */
+    DatagramSocket(const char* local_path, const char* peer_path);
+
+    /// @brief destructor
+    ~DatagramSocket();
+
+    /// @brief deleted copy constructor
+    DatagramSocket(const DatagramSocket&) = delete;
+
+    /// @brief deleted move constructor
+    DatagramSocket(DatagramSocket&&) = delete;
+
+    /// @brief deleted copy assignment operator
+    DatagramSocket& operator=(const DatagramSocket&) = delete;
+
+    /// @brief deleted move assignment operator
+    DatagramSocket& operator=(DatagramSocket&&) = delete;
+
+    /**
+     * @brief Send datagrams to the peer
+     *
+     * Blocks until all datagrams are passed to the kernel or dropped.
+     * Safe to call from many threads, each datagram is sent atomically.
+     *
+     * @param messages      datagrams to send, msg_name is set to the peer address
+     * @param count         number of datagrams
+     *
+     * @return number of datagrams sent, the remaining ones are dropped
+     */
+    size_t send(mmsghdr* messages, size_t count);
+
+    /**
+     * @brief Receive datagrams from the peer
+     *
+     * Blocks until at least one datagram is received, then returns all
+     * datagrams available without blocking, up to count.
+     *
+     * @param messages      buffers for datagrams, msg_len is set to the received length
+     * @param count         number of buffers
+     *
+     * @return number of received datagrams
+     */
+    size_t receive(mmsghdr* messages, size_t count);
+
+    /**
+     * @brief Get the number of datagrams dropped by send
+     *
+     * @return number of dropped datagrams
+     */
+    uint64_t dropped_datagrams() const;
+
+  private:
+    int m_descriptor;
+    std::string m_local_path;
+    sockaddr_storage m_peer_address;
+    socklen_t m_peer_address_length;
+    std::atomic<uint64_t> m_dropped_datagrams;
+};
+} // namespace taste
+
+#endif
@@ -0,0 +1,382 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "EnvironmentCheck.h"
+
+#include "Sysfs.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+/// Timer wakeup latency above which a warning is reported
+#ifndef RT_ENVIRONMENT_CHECK_MAX_JITTER_US
+#define RT_ENVIRONMENT_CHECK_MAX_JITTER_US 100
+#endif
+
+namespace taste {
+namespace {
+const char* const CPU_SYSFS_PATH = "/sys/devices/system/cpu/";
+constexpr uint64_t CAP_SYS_NICE_BIT = 23;
+constexpr uint64_t JITTER_PERIOD_NS = 1000000;
+constexpr uint64_t NANOSECONDS_IN_SECOND = 1000000000;
+constexpr uint64_t NANOSECONDS_IN_MILLISECOND = 1000000;
+constexpr uint64_t NANOSECONDS_IN_MICROSECOND = 1000;
+
+std::once_flag startup_check_flag;
+
+bool
+contains(const std::vector<int>& cpus, int cpu)
+{
+    return std::find(cpus.begin(), cpus.end(), cpu) != cpus.end();
+}
+
+void
+report(std::ostream& stream, bool warning, const char* check, const std::string& message, unsigned int& warnings)
+{
+    stream << (warning ? "  [warn] " : "  [ok]   ") << check << ": " << message << std::endl;
+    if(warning) {
+        ++warnings;
+    }
+}
+
+void
+report_unavailable(std::ostream& stream, const char* check, const std::string& message)
+{
+    stream << "  [n/a]  " << check << ": " << message << std::endl;
+}
+
+std::string
+format_cpus(const std::vector<int>& cpus)
+{
+    std::ostringstream stream;
+    for(size_t i = 0; i < cpus.size(); ++i) {
+        stream << (i == 0 ? "" : ",") << cpus[i];
+    }
+    return stream.str();
+}
+
+uint64_t
+monotonic_ns()
+{
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return static_cast<uint64_t>(time.tv_sec) * NANOSECONDS_IN_SECOND + static_cast<uint64_t>(time.tv_nsec);
+}
+
+struct JitterMeasurement
+{
+    size_t sample_count;
+    std::vector<uint64_t> latencies;
+    int error;
+};
+
+void*
+jitter_thread(void* param)
+{
+    JitterMeasurement& measurement = *static_cast<JitterMeasurement*>(param);
+    uint64_t wakeup_time = monotonic_ns() + JITTER_PERIOD_NS;
+    for(size_t i = 0; i < measurement.sample_count; ++i) {
+        timespec wakeup;
+        wakeup.tv_sec = static_cast<time_t>(wakeup_time / NANOSECONDS_IN_SECOND);
+        wakeup.tv_nsec = static_cast<long>(wakeup_time % NANOSECONDS_IN_SECOND);
+        int result = 0;
+        do {
+            result = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeup, nullptr);
+        } while(result == EINTR);
+        if(result != 0) {
+            measurement.error = result;
+            return nullptr;
+        }
+        const uint64_t now = monotonic_ns();
+        measurement.latencies.push_back(now > wakeup_time ? now - wakeup_time : 0);
+        wakeup_time += JITTER_PERIOD_NS;
+    }
+    return nullptr;
+}
+} // namespace
+
+unsigned int
+EnvironmentCheck::run(std::ostream& stream, uint64_t jitter_ms)
+{
+    unsigned int warnings = 0;
+    stream << "Real-time environment check:" << std::endl;
+    check_frequency_governors(stream, warnings);
+    check_smt(stream, warnings);
+    check_interrupts(stream, warnings);
+    check_rt_throttling(stream, warnings);
+    check_priority_permission(stream, warnings);
+    if(jitter_ms != 0) {
+        measure_timer_jitter(stream, jitter_ms, warnings);
+    }
+    stream << "Real-time environment check found " << warnings << " warnings" << std::endl;
+    return warnings;
+}
+
+void
+EnvironmentCheck::run_at_startup()
+{
+    std::call_once(startup_check_flag, []() { run(std::cerr); });
+}
+
+void
+EnvironmentCheck::check_frequency_governors(std::ostream& stream, unsigned int& warnings)
+{
+    const char* const check = "cpu frequency governor";
+    std::vector<int> slow_cpus;
+    std::string slow_governor;
+    size_t checked_cpus = 0;
+    for(const int cpu : Sysfs::read_cpu_list(std::string(CPU_SYSFS_PATH) + "online")) {
+        std::string governor;
+        if(!Sysfs::read_line(std::string(CPU_SYSFS_PATH) + "cpu" + std::to_string(cpu) + "/cpufreq/scaling_governor",
+                             governor)) {
+            continue;
+        }
+        ++checked_cpus;
+        if(governor != "performance") {
+            slow_cpus.push_back(cpu);
+            slow_governor = governor;
+        }
+    }
+
+    if(checked_cpus == 0) {
+        report_unavailable(stream, check, "cpufreq is not available");
+    } else if(!slow_cpus.empty()) {
+        report(stream,
+               true,
+               check,
+               "CPUs " + format_cpus(slow_cpus) + " do not use 'performance', e.g. '" + slow_governor + "'",
+               warnings);
+    } else {
+        report(stream, false, check, "all CPUs use 'performance'", warnings);
+    }
+}
+
+void
+EnvironmentCheck::check_smt(std::ostream& stream, unsigned int& warnings)
+{
+    const char* const check = "SMT";
+    std::string active;
+    if(!Sysfs::read_line(std::string(CPU_SYSFS_PATH) + "smt/active", active)) {
+        report_unavailable(stream, check, "SMT state is not available");
+        return;
+    }
+    if(active != "1") {
+        report(stream, false, check, "disabled", warnings);
+        return;
+    }
+
+    // isolated CPUs shall not share a core with CPUs running other threads
+    const std::vector<int> isolated = Sysfs::read_cpu_list(std::string(CPU_SYSFS_PATH) + "isolated");
+    std::vector<int> exposed;
+    for(const int cpu : isolated) {
+        for(const int sibling : Sysfs::read_cpu_list(std::string(CPU_SYSFS_PATH) + "cpu" + std::to_string(cpu)
+                                                     + "/topology/thread_siblings_list")) {
+            if(!contains(isolated, sibling)) {
+                exposed.push_back(cpu);
+                break;
+            }
+        }
+    }
+
+    if(!exposed.empty()) {
+        report(stream,
+               true,
+               check,
+               "isolated CPUs " + format_cpus(exposed) + " share a core with not isolated CPUs",
+               warnings);
+    } else {
+        report(stream, true, check, "enabled, runtime threads may share a core with noisy threads", warnings);
+    }
+}
+
+void
+EnvironmentCheck::check_interrupts(std::ostream& stream, unsigned int& warnings)
+{
+    const char* const check = "IRQ affinity";
+    const std::vector<int> isolated = Sysfs::read_cpu_list(std::string(CPU_SYSFS_PATH) + "isolated");
+    if(isolated.empty()) {
+        report_unavailable(stream, check, "there are no isolated CPUs");
+        return;
+    }
+
+    DIR* directory = opendir("/proc/irq");
+    if(directory == nullptr) {
+        report_unavailable(stream, check, "/proc/irq is not available");
+        return;
+    }
+    std::vector<std::string> interrupts;
+    while(const dirent* entry = readdir(directory)) {
+        const std::string name = entry->d_name;
+        if(name.find_first_not_of("0123456789") != std::string::npos) {
+            continue;
+        }
+        for(const int cpu : Sysfs::read_cpu_list("/proc/irq/" + name + "/smp_affinity_list")) {
+            if(contains(isolated, cpu)) {
+                interrupts.push_back(name);
+                break;
+            }
+        }
+    }
+    closedir(directory);
+
+    if(!interrupts.empty()) {
+        std::string list;
+        for(const std::string& interrupt : interrupts) {
+            list += (list.empty() ? "" : ",") + interrupt;
+        }
+        report(stream,
+               true,
+               check,
+               std::to_string(interrupts.size()) + " IRQs may be handled by isolated CPUs " + format_cpus(isolated)
+                       + ": " + list,
+               warnings);
+    } else {
+        report(stream, false, check, "no IRQs are handled by isolated CPUs " + format_cpus(isolated), warnings);
+    }
+}
+
+void
+EnvironmentCheck::check_rt_throttling(std::ostream& stream, unsigned int& warnings)
+{
+    const char* const check = "RT throttling";
+    std::string runtime;
+    std::string period;
+    if(!Sysfs::read_line("/proc/sys/kernel/sched_rt_runtime_us", runtime)
+       || !Sysfs::read_line("/proc/sys/kernel/sched_rt_period_us", period)) {
+        report_unavailable(stream, check, "RT throttling settings are not available");
+        return;
+    }
+
+    if(runtime == "-1") {
+        report(stream, false, check, "disabled", warnings);
+    } else {
+        report(stream,
+               true,
+               check,
+               "real-time threads may run only " + runtime + " us of every " + period
+                       + " us, see /proc/sys/kernel/sched_rt_runtime_us",
+               warnings);
+    }
+}
+
+void
+EnvironmentCheck::check_priority_permission(std::ostream& stream, unsigned int& warnings)
+{
+    const char* const check = "real-time priority permission";
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    uint64_t capabilities = 0;
+    while(std::getline(status, line)) {
+        if(line.compare(0, 7, "CapEff:") == 0) {
+            capabilities = std::strtoull(line.c_str() + 7, nullptr, 16);
+        }
+    }
+
+    rlimit limit;
+    const bool has_rtprio_limit = getrlimit(RLIMIT_RTPRIO, &limit) == 0 && limit.rlim_cur > 0;
+    if((capabilities & (uint64_t(1) << CAP_SYS_NICE_BIT)) != 0) {
+        report(stream, false, check, "CAP_SYS_NICE is available", warnings);
+    } else if(has_rtprio_limit) {
+        report(stream,
+               false,
+               check,
+               "priorities up to " + std::to_string(limit.rlim_cur) + " are permitted by RLIMIT_RTPRIO",
+               warnings);
+    } else {
+        report(stream,
+               true,
+               check,
+               "neither CAP_SYS_NICE nor RLIMIT_RTPRIO is available, creation of runtime threads will fail",
+               warnings);
+    }
+}
+
+void
+EnvironmentCheck::measure_timer_jitter(std::ostream& stream, uint64_t jitter_ms, unsigned int& warnings)
+{
+    const char* const check = "timer jitter";
+    JitterMeasurement measurement;
+    measurement.sample_count = static_cast<size_t>(jitter_ms * NANOSECONDS_IN_MILLISECOND / JITTER_PERIOD_NS);
+    measurement.latencies.reserve(measurement.sample_count);
+    measurement.error = 0;
+
+    // the calling thread is usually not a real-time one, its wakeup latency is not relevant for the runtime
+    const int priority = sched_get_priority_max(SCHED_FIFO);
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_setinheritsched(&attributes, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attributes, SCHED_FIFO);
+    sched_param parameters;
+    parameters.sched_priority = priority;
+    pthread_attr_setschedparam(&attributes, &parameters);
+    pthread_t thread;
+    const int result = pthread_create(&thread, &attributes, jitter_thread, &measurement);
+    pthread_attr_destroy(&attributes);
+    if(result == EPERM) {
+        report_unavailable(stream, check, "SCHED_FIFO threads are not permitted, wakeup latency not measured");
+        return;
+    }
+    if(result != 0) {
+        report_unavailable(stream, check, std::string("unable to create measurement thread: ") + std::strerror(result));
+        return;
+    }
+    pthread_join(thread, nullptr);
+
+    if(measurement.error != 0) {
+        report_unavailable(stream, check, std::string("clock_nanosleep failed: ") + std::strerror(measurement.error));
+        return;
+    }
+    std::vector<uint64_t>& latencies = measurement.latencies;
+    if(latencies.empty()) {
+        return;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    const uint64_t median = latencies[latencies.size() / 2];
+    const uint64_t p99 = latencies[latencies.size() * 99 / 100];
+    const uint64_t maximum = latencies.back();
+    std::ostringstream message;
+    message << "wakeup latency of SCHED_FIFO thread with priority " << priority << " over " << jitter_ms
+            << " ms: p50 " << median / NANOSECONDS_IN_MICROSECOND << " us, p99 " << p99 / NANOSECONDS_IN_MICROSECOND
+            << " us, max " << maximum / NANOSECONDS_IN_MICROSECOND << " us";
+    report(stream,
+           maximum > RT_ENVIRONMENT_CHECK_MAX_JITTER_US * NANOSECONDS_IN_MICROSECOND,
+           check,
+           message.str(),
+           warnings);
+}
+} // namespace taste
@@ -0,0 +1,101 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_ENVIRONMENT_CHECK_H
+#define TASTE_ENVIRONMENT_CHECK_H
+
+/**
+ * @file    EnvironmentCheck.h
+ * @brief   Startup check of host configuration affecting real-time behaviour.
+ */
+
+#include <cstdint>
+#include <ostream>
+
+/// Duration of timer jitter measurement, 0 disables the measurement
+#ifndef RT_ENVIRONMENT_CHECK_JITTER_MS
+#define RT_ENVIRONMENT_CHECK_JITTER_MS 0
+#endif
+
+namespace taste {
+/**
+ * @brief Inspection of host configuration in sysfs and procfs.
+ *
+ * The check reports:
+ *  - CPU frequency governors other than performance,
+ *  - enabled SMT and isolated CPUs sharing a core with not isolated ones,
+ *  - interrupts which may be handled by isolated CPUs,
+ *  - RT throttling limiting the runtime of real-time threads,
+ *  - missing permission to create SCHED_FIFO threads,
+ *  - optionally, wakeup latency of a periodic timer in a short-lived SCHED_FIFO thread,
+ *    not measured if real-time priorities are not permitted.
+ *
+ * If RT_ENVIRONMENT_CHECK is defined, the report is printed by Hal_Init.
+ */
+class EnvironmentCheck final
+{
+  public:
+    /**
+     * @brief Deleted default constructor.
+     */
+    EnvironmentCheck() = delete;
+
+    /**
+     * @brief Check if the report is printed by Hal_Init.
+     *
+     * @return true if RT_ENVIRONMENT_CHECK is defined, otherwise false
+     */
+    static constexpr bool is_enabled()
+    {
+#ifdef RT_ENVIRONMENT_CHECK
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Inspect the host and print the report.
+     *
+     * @param stream        output stream
+     * @param jitter_ms     duration of timer jitter measurement, 0 to skip it
+     *
+     * @return number of warnings
+     */
+    static unsigned int run(std::ostream& stream, uint64_t jitter_ms = RT_ENVIRONMENT_CHECK_JITTER_MS);
+
+    /**
+     * @brief Print the report once, using std::cerr.
+     */
+    static void run_at_startup();
+
+  private:
+    static void check_frequency_governors(std::ostream& stream, unsigned int& warnings);
+    static void check_smt(std::ostream& stream, unsigned int& warnings);
+    static void check_interrupts(std::ostream& stream, unsigned int& warnings);
+    static void check_rt_throttling(std::ostream& stream, unsigned int& warnings);
+    static void check_priority_permission(std::ostream& stream, unsigned int& warnings);
+    static void measure_timer_jitter(std::ostream& stream, uint64_t jitter_ms, unsigned int& warnings);
+};
+} // namespace taste
+
+#endif
@@ -0,0 +1,279 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ExecutionStatistics.h"
+
+#include "Clock.h"
+
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include <time.h>
+
+namespace taste {
+namespace {
+struct Registry
+{
+    std::mutex mutex;
+    ExecutionStatistics* head = nullptr;
+    std::vector<ExecutionStatistics::Summary> retired;
+
+    ~Registry()
+    {
+#ifdef RT_EXECUTION_PROFILING_DUMP_AT_EXIT
+        ExecutionStatistics::print_all(std::cerr);
+#endif
+    }
+};
+
+Registry&
+registry()
+{
+    // constructed by the first interface, therefore destroyed after all static statistics
+    static Registry instance;
+    return instance;
+}
+
+void
+print_distribution(std::ostream& stream,
+                   const char* title,
+                   uint64_t maximum,
+                   const ExecutionStatistics::Histogram& histogram)
+{
+    constexpr double NANOSECONDS_IN_MICROSECOND = 1000.0;
+    constexpr double FRACTIONS[] = { 0.5, 0.9, 0.99, 0.999 };
+    const char* const LABELS[] = { "p50", "p90", "p99", "p99.9" };
+
+    stream << "    " << title << " [us]:";
+    for(size_t i = 0; i < sizeof(FRACTIONS) / sizeof(FRACTIONS[0]); ++i) {
+        // buckets are wider than the exact maximum
+        const uint64_t value = std::min(ExecutionStatistics::percentile(histogram, FRACTIONS[i]), maximum);
+        stream << " " << LABELS[i] << " " << static_cast<double>(value) / NANOSECONDS_IN_MICROSECOND << ",";
+    }
+    stream << " max " << static_cast<double>(maximum) / NANOSECONDS_IN_MICROSECOND << std::endl;
+}
+} // namespace
+
+ExecutionStatistics::ExecutionStatistics(const char* name, uint64_t deadline_ns)
+    : m_name(name)
+    , m_deadline_ns(deadline_ns)
+    , m_activations(0)
+    , m_deadline_misses(0)
+    , m_max_execution_time_ns(0)
+    , m_max_cpu_time_ns(0)
+    , m_max_response_time_ns(0)
+    , m_execution_time_histogram()
+    , m_cpu_time_histogram()
+    , m_response_time_histogram()
+    , m_previous(nullptr)
+{
+    Registry& instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    m_next = instance.head;
+    if(m_next != nullptr) {
+        m_next->m_previous = this;
+    }
+    instance.head = this;
+}
+
+ExecutionStatistics::~ExecutionStatistics()
+{
+    Registry& instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    if(m_activations.load(std::memory_order_relaxed) != 0) {
+        instance.retired.push_back(summary());
+    }
+    if(m_previous != nullptr) {
+        m_previous->m_next = m_next;
+    } else {
+        instance.head = m_next;
+    }
+    if(m_next != nullptr) {
+        m_next->m_previous = m_previous;
+    }
+}
+
+ExecutionStatistics::Activation
+ExecutionStatistics::start(uint64_t release_time_ns)
+{
+    Activation activation;
+    activation.start_time_ns = Clock::now_ns();
+    activation.start_cpu_time_ns = thread_cpu_time_ns();
+    activation.release_time_ns = release_time_ns != 0 ? release_time_ns : activation.start_time_ns;
+    return activation;
+}
+
+void
+ExecutionStatistics::finish(const Activation& activation)
+{
+    const uint64_t end_cpu_time_ns = thread_cpu_time_ns();
+    const uint64_t end_time_ns = Clock::now_ns();
+    const uint64_t execution_time_ns = end_time_ns - activation.start_time_ns;
+    const uint64_t cpu_time_ns = end_cpu_time_ns - activation.start_cpu_time_ns;
+    const uint64_t response_time_ns =
+            end_time_ns > activation.release_time_ns ? end_time_ns - activation.release_time_ns : 0;
+
+    m_activations.fetch_add(1, std::memory_order_relaxed);
+    update_maximum(m_max_execution_time_ns, execution_time_ns);
+    update_maximum(m_max_cpu_time_ns, cpu_time_ns);
+    update_maximum(m_max_response_time_ns, response_time_ns);
+    m_execution_time_histogram[bucket_of(execution_time_ns)].fetch_add(1, std::memory_order_relaxed);
+    m_cpu_time_histogram[bucket_of(cpu_time_ns)].fetch_add(1, std::memory_order_relaxed);
+    m_response_time_histogram[bucket_of(response_time_ns)].fetch_add(1, std::memory_order_relaxed);
+
+    if(m_deadline_ns != 0 && response_time_ns > m_deadline_ns) {
+        m_deadline_misses.fetch_add(1, std::memory_order_relaxed);
+        const DeadlineMissHook hook = m_deadline_miss_hook.load(std::memory_order_acquire);
+        if(hook != nullptr) {
+            hook(m_name, response_time_ns, m_deadline_ns);
+        }
+    }
+}
+
+void
+ExecutionStatistics::set_deadline_miss_hook(DeadlineMissHook hook)
+{
+    m_deadline_miss_hook.store(hook, std::memory_order_release);
+}
+
+ExecutionStatistics::Summary
+ExecutionStatistics::summary() const
+{
+    Summary result;
+    result.name = m_name;
+    result.deadline_ns = m_deadline_ns;
+    result.activations = m_activations.load(std::memory_order_relaxed);
+    result.deadline_misses = m_deadline_misses.load(std::memory_order_relaxed);
+    result.max_execution_time_ns = m_max_execution_time_ns.load(std::memory_order_relaxed);
+    result.max_cpu_time_ns = m_max_cpu_time_ns.load(std::memory_order_relaxed);
+    result.max_response_time_ns = m_max_response_time_ns.load(std::memory_order_relaxed);
+    for(size_t i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        result.execution_time_histogram[i] = m_execution_time_histogram[i].load(std::memory_order_relaxed);
+        result.cpu_time_histogram[i] = m_cpu_time_histogram[i].load(std::memory_order_relaxed);
+        result.response_time_histogram[i] = m_response_time_histogram[i].load(std::memory_order_relaxed);
+    }
+
+    return result;
+}
+
+uint64_t
+ExecutionStatistics::percentile(const Histogram& histogram, double fraction)
+{
+    uint64_t total = 0;
+    for(const uint64_t count : histogram) {
+        total += count;
+    }
+    if(total == 0) {
+        return 0;
+    }
+
+    const uint64_t rank = static_cast<uint64_t>(fraction * static_cast<double>(total - 1)) + 1;
+    uint64_t accumulated = 0;
+    for(size_t bucket = 0; bucket < HISTOGRAM_BUCKETS; ++bucket) {
+        accumulated += histogram[bucket];
+        if(accumulated >= rank) {
+            return bucket_upper_bound(bucket);
+        }
+    }
+    return bucket_upper_bound(HISTOGRAM_BUCKETS - 1);
+}
+
+void
+ExecutionStatistics::print_all(std::ostream& stream)
+{
+    std::vector<Summary> summaries;
+    {
+        Registry& instance = registry();
+        std::lock_guard<std::mutex> lock(instance.mutex);
+        summaries = instance.retired;
+        for(const ExecutionStatistics* statistics = instance.head; statistics != nullptr;
+            statistics = statistics->m_next) {
+            summaries.push_back(statistics->summary());
+        }
+    }
+
+    std::sort(summaries.begin(), summaries.end(), [](const Summary& lhs, const Summary& rhs) {
+        return lhs.max_execution_time_ns > rhs.max_execution_time_ns;
+    });
+
+    stream << "Execution statistics (" << summaries.size() << " interfaces):" << std::endl;
+    for(const Summary& summary : summaries) {
+        if(summary.activations == 0) {
+            continue;
+        }
+        stream << "  " << (summary.name != nullptr ? summary.name : "<unnamed>") << ": activations "
+               << summary.activations;
+        if(summary.deadline_ns != 0) {
+            stream << ", deadline " << summary.deadline_ns << "ns, misses " << summary.deadline_misses;
+        }
+        stream << std::endl;
+        print_distribution(stream, "execution", summary.max_execution_time_ns, summary.execution_time_histogram);
+        print_distribution(stream, "cpu", summary.max_cpu_time_ns, summary.cpu_time_histogram);
+        print_distribution(stream, "response", summary.max_response_time_ns, summary.response_time_histogram);
+    }
+}
+
+size_t
+ExecutionStatistics::bucket_of(uint64_t value)
+{
+    // values below 8 have exact buckets, larger values have 8 buckets per power of two
+    if(value < HISTOGRAM_SUB_BUCKETS) {
+        return static_cast<size_t>(value);
+    }
+    const size_t exponent = static_cast<size_t>(63 - __builtin_clzll(value));
+    const size_t sub_bucket = static_cast<size_t>(value >> (exponent - 3)) & (HISTOGRAM_SUB_BUCKETS - 1);
+    return std::min((exponent - 2) * HISTOGRAM_SUB_BUCKETS + sub_bucket, HISTOGRAM_BUCKETS - 1);
+}
+
+uint64_t
+ExecutionStatistics::bucket_upper_bound(size_t bucket)
+{
+    if(bucket < HISTOGRAM_SUB_BUCKETS) {
+        return bucket;
+    }
+    const size_t exponent = bucket / HISTOGRAM_SUB_BUCKETS + 2;
+    const uint64_t sub_bucket = bucket % HISTOGRAM_SUB_BUCKETS;
+    return ((HISTOGRAM_SUB_BUCKETS + sub_bucket + 1) << (exponent - 3)) - 1;
+}
+
+void
+ExecutionStatistics::update_maximum(std::atomic<uint64_t>& maximum, uint64_t value)
+{
+    uint64_t current = maximum.load(std::memory_order_relaxed);
+    while(value > current && !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t
+ExecutionStatistics::thread_cpu_time_ns()
+{
+    constexpr uint64_t NANOSECONDS_IN_SECOND = 1000000000ULL;
+
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return static_cast<uint64_t>(time.tv_sec) * NANOSECONDS_IN_SECOND + static_cast<uint64_t>(time.tv_nsec);
+}
+
+std::atomic<ExecutionStatistics::DeadlineMissHook> ExecutionStatistics::m_deadline_miss_hook(nullptr);
+} // namespace taste
@@ -0,0 +1,264 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_EXECUTION_STATISTICS_H
+#define TASTE_EXECUTION_STATISTICS_H
+
+/**
+ * @file    ExecutionStatistics.h
+ * @brief   Execution time and deadline statistics of interfaces.
+ */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace taste {
+/**
+ * @brief Execution time statistics of single interface.
+ *
+ * Each activation is measured using wall time and thread CPU time.
+ * The response time, measured from the release of the activation,
+ * is checked against the deadline, and misses are counted and reported
+ * to the deadline miss hook. Maximum values are exact, percentiles
+ * are computed from log-linear histograms with 8 buckets per power of two,
+ * so they are accurate to 12.5%.
+ *
+ * Activations can be recorded from multiple threads concurrently, either by
+ * pairing start with finish, or by wrapping the handler call in a Scope.
+ * Timer, WorkerPool and SporadicPoller record their activations if RT_EXECUTION_PROFILING
+ * is defined. The statistics of all interfaces are printed at exit if
+ * RT_EXECUTION_PROFILING_DUMP_AT_EXIT is defined.
+ */
+class ExecutionStatistics final
+{
+  public:
+    /// Number of sub-buckets per power of two
+    static constexpr size_t HISTOGRAM_SUB_BUCKETS = 8;
+
+    /// Number of histogram buckets, covering durations up to 2^40 ns
+    static constexpr size_t HISTOGRAM_BUCKETS = (40 - 2) * HISTOGRAM_SUB_BUCKETS;
+
+    /// Type of histograms
+    using Histogram = std::array<uint64_t, HISTOGRAM_BUCKETS>;
+
+    /**
+     * @brief Type definition of deadline miss hook
+     *
+     * @param name              name of the interface
+     * @param response_time_ns  response time of the activation
+     * @param deadline_ns       deadline of the interface
+     */
+    using DeadlineMissHook = void (*)(const char* name, uint64_t response_time_ns, uint64_t deadline_ns);
+
+    /// Measurement of single activation in progress
+    struct Activation
+    {
+        /// Release time of the activation
+        uint64_t release_time_ns;
+        /// Wall time at the start of execution
+        uint64_t start_time_ns;
+        /// Thread CPU time at the start of execution
+        uint64_t start_cpu_time_ns;
+    };
+
+    /**
+     * @brief Measurement of activation lasting until the end of the scope
+     *
+     * The measurement starts on construction and is finished by the destructor,
+     * so a loop can wrap the handler call without pairing start with finish.
+     */
+    class Scope final
+    {
+      public:
+        /**
+         * @brief Constructor, starts the measurement
+         *
+         * @param statistics        statistics of the interface
+         * @param release_time_ns   time when the activation was released,
+         *                          0 to use the start of execution
+         */
+        explicit Scope(ExecutionStatistics& statistics, uint64_t release_time_ns = 0)
+            : m_statistics(statistics)
+            , m_activation(ExecutionStatistics::start(release_time_ns))
+        {
+        }
+
+        /// @brief destructor, finishes the measurement
+        ~Scope() { m_statistics.finish(m_activation); }
+
+        /// @brief deleted copy constructor
+        Scope(const Scope&) = delete;
+
+        /// @brief deleted move constructor
+        Scope(Scope&&) = delete;
+
+        /// @brief deleted copy assignment operator
+        Scope& operator=(const Scope&) = delete;
+
+        /// @brief deleted move assignment operator
+        Scope& operator=(Scope&&) = delete;
+
+      private:
+        ExecutionStatistics& m_statistics;
+        const Activation m_activation;
+    };
+
+    /// Copy of the statistics
+    struct Summary
+    {
+        /// Name of the interface
+        const char* name;
+        /// Deadline, 0 if not checked
+        uint64_t deadline_ns;
+        /// Number of activations
+        uint64_t activations;
+        /// Number of deadline misses
+        uint64_t deadline_misses;
+        /// Maximum wall execution time
+        uint64_t max_execution_time_ns;
+        /// Maximum thread CPU time
+        uint64_t max_cpu_time_ns;
+        /// Maximum response time
+        uint64_t max_response_time_ns;
+        /// Wall execution time histogram
+        Histogram execution_time_histogram;
+        /// Thread CPU time histogram
+        Histogram cpu_time_histogram;
+        /// Response time histogram
+        Histogram response_time_histogram;
+    };
+
+    /**
+     * @brief Constructor
+     *
+     * Registers statistics in the global registry.
+     *
+     * @param name          name of the interface, may be nullptr
+     * @param deadline_ns   relative deadline, 0 if not checked
+     */
+    explicit ExecutionStatistics(const char* name, uint64_t deadline_ns = 0);
+
+    /// @brief destructor, keeps copy of statistics for the final report
+    ~ExecutionStatistics();
+
+    /// @brief deleted copy constructor
+    ExecutionStatistics(const ExecutionStatistics&) = delete;
+
+    /// @brief deleted move constructor
+    ExecutionStatistics(ExecutionStatistics&&) = delete;
+
+    /// @brief deleted copy assignment operator
+    ExecutionStatistics& operator=(const ExecutionStatistics&) = delete;
+
+    /// @brief deleted move assignment operator
+    ExecutionStatistics& operator=(ExecutionStatistics&&) = delete;
+
+    /**
+     * @brief Start measurement of activation
+     *
+     * @param release_time_ns   time when the activation was released,
+     *                          0 to use the start of execution
+     *
+     * @return activation in progress
+     */
+    static Activation start(uint64_t release_time_ns = 0);
+
+    /**
+     * @brief Finish measurement of activation
+     *
+     * @param activation    activation returned by start
+     */
+    void finish(const Activation& activation);
+
+    /**
+     * @brief Set hook called on every deadline miss
+     *
+     * The hook is called by the thread which missed the deadline.
+     *
+     * @param hook      deadline miss hook, nullptr to disable
+     */
+    static void set_deadline_miss_hook(DeadlineMissHook hook);
+
+    /**
+     * @brief Copy the statistics.
+     *
+     * @return summary of the statistics
+     */
+    Summary summary() const;
+
+    /**
+     * @brief Compute percentile from histogram
+     *
+     * @param histogram     histogram of durations
+     * @param fraction      requested fraction, e.g. 0.99
+     *
+     * @return upper bound of the bucket containing the percentile
+     */
+    static uint64_t percentile(const Histogram& histogram, double fraction);
+
+    /**
+     * @brief Find histogram bucket of duration
+     *
+     * @param value         duration in nanoseconds
+     *
+     * @return index of the bucket, durations over the range fall into the last bucket
+     */
+    static size_t bucket_of(uint64_t value);
+
+    /**
+     * @brief Print statistics of all interfaces.
+     *
+     * @param stream   output stream
+     */
+    static void print_all(std::ostream& stream);
+
+  private:
+    using AtomicHistogram = std::array<std::atomic<uint64_t>, HISTOGRAM_BUCKETS>;
+
+    static uint64_t bucket_upper_bound(size_t bucket);
+    static void update_maximum(std::atomic<uint64_t>& maximum, uint64_t value);
+    static uint64_t thread_cpu_time_ns();
+
+  private:
+    const char* m_name;
+    const uint64_t m_deadline_ns;
+
+    std::atomic<uint64_t> m_activations;
+    std::atomic<uint64_t> m_deadline_misses;
+    std::atomic<uint64_t> m_max_execution_time_ns;
+    std::atomic<uint64_t> m_max_cpu_time_ns;
+    std::atomic<uint64_t> m_max_response_time_ns;
+    AtomicHistogram m_execution_time_histogram;
+    AtomicHistogram m_cpu_time_histogram;
+    AtomicHistogram m_response_time_histogram;
+
+    ExecutionStatistics* m_previous;
+    ExecutionStatistics* m_next;
+
+    static std::atomic<DeadlineMissHook> m_deadline_miss_hook;
+};
+} // namespace taste
+
+#endif
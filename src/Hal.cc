@@ -31,9 +31,23 @@ extern "C"
 
     bool Hal_SleepNs(uint64_t time_ns) { return taste::Hal::sleepNs(time_ns); }
 
+    bool Hal_SleepUntilNs(uint64_t wakeup_time_ns) { return taste::Hal::sleepUntilNs(wakeup_time_ns); }
+
     int32_t Hal_SemaphoreCreate(void) { return taste::Hal::semaphoreCreate(); }
 
+    int32_t Hal_SemaphoreCreateCounting(uint32_t initial_count)
+    {
+        return taste::Hal::semaphoreCreateCounting(initial_count);
+    }
+
     bool Hal_SemaphoreObtain(int32_t id) { return taste::Hal::semaphoreObtain(id); }
 
+    bool Hal_SemaphoreObtainTimeout(int32_t id, uint64_t timeout_ns)
+    {
+        return taste::Hal::semaphoreObtainTimeout(id, timeout_ns);
+    }
+
+    bool Hal_SemaphoreTryObtain(int32_t id) { return taste::Hal::semaphoreTryObtain(id); }
+
     bool Hal_SemaphoreRelease(int32_t id) { return taste::Hal::semaphoreRelease(id); }
 }
\ No newline at end of file
@@ -60,14 +60,39 @@ extern "C"
     bool Hal_SleepNs(uint64_t time_ns);
 
     /**
-     * @brief               Creates an RTOS backed semaphore. This function is not
+     * @brief               Suspends the current thread until the given point in time
+     *
+     * @param[in] wakeup_time_ns    time elapsed from the initialization of the
+     *                              runtime, in nanoseconds, as returned by
+     *                              Hal_GetElapsedTimeInNs
+     *
+     * @return              Bool indicating whether the sleep was successful
+     */
+    bool Hal_SleepUntilNs(uint64_t wakeup_time_ns);
+
+    /**
+     * @brief               Creates an RTOS backed binary semaphore, which is
+     *                      initially available. This function is not
      *                      thread safe, but it is assumed to be used only during
      *                      system initialization, from a single thread/Init task.
      *
-     * @return              ID of the created semaphore
+     * @return              ID of the created semaphore, starting at 1, or -1 if
+     *                      the limit of semaphores has been reached
      */
     int32_t Hal_SemaphoreCreate(void);
 
+    /**
+     * @brief               Creates an RTOS backed counting semaphore. This function
+     *                      is not thread safe, but it is assumed to be used only
+     *                      during system initialization, from a single thread/Init task.
+     *
+     * @param[in] initial_count     initial value of the semaphore counter
+     *
+     * @return              ID of the created semaphore, starting at 1, or -1 if
+     *                      the limit of semaphores has been reached
+     */
+    int32_t Hal_SemaphoreCreateCounting(uint32_t initial_count);
+
     /**
      * @brief               Obtains the indicated semaphore, suspending the
      *                      execution of the current thread if necessary.
@@ -78,6 +103,29 @@ extern "C"
      */
     bool Hal_SemaphoreObtain(int32_t id);
 
+    /**
+     * @brief               Obtains the indicated semaphore, suspending the
+     *                      execution of the current thread at most for the
+     *                      given amount of time.
+     *
+     * @param[in] id        id of the semaphore
+     * @param[in] timeout_ns    maximum waiting time in nanoseconds
+     *
+     * @return              Bool indicating whether the obtain was successful,
+     *                      false on timeout
+     */
+    bool Hal_SemaphoreObtainTimeout(int32_t id, uint64_t timeout_ns);
+
+    /**
+     * @brief               Obtains the indicated semaphore if it is available,
+     *                      without suspending the execution of the current thread.
+     *
+     * @param[in] id        id of the semaphore
+     *
+     * @return              Bool indicating whether the obtain was successful
+     */
+    bool Hal_SemaphoreTryObtain(int32_t id);
+
     /**
      * @brief               Releases the indicated semaphore, potentially resuming
      *                      threads waiting on the semaphore
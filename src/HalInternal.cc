@@ -22,16 +22,28 @@
 
 #include "HalInternal.h"
 
+#include "Clock.h"
+#include "EnvironmentCheck.h"
+#include "MemoryReport.h"
+
+#include <cerrno>
 #include <chrono>
+#include <limits>
 #include <thread>
 #include <limits.h>
+#include <time.h>
 
 namespace taste {
 
 bool
 Hal::init()
 {
-    m_init_time_stamp = std::chrono::steady_clock::now();
+    Clock::initialize();
+    if(EnvironmentCheck::is_enabled()) {
+        // threads are not created yet, so missing permissions are reported before they terminate the program
+        EnvironmentCheck::run_at_startup();
+    }
+    MemoryReport::remove(MemoryReport::Category::HalObjects, m_created_semaphores_count * sizeof(Semaphore));
     m_created_semaphores_count = 0;
 
     return true;
@@ -40,51 +52,127 @@ Hal::init()
 uint64_t
 Hal::getElapsedTimeInNs(void)
 {
-    std::chrono::steady_clock::time_point now_time_stamp = std::chrono::steady_clock::now();
-
-    auto elapsed_time =
-            std::chrono::duration_cast<std::chrono::nanoseconds>(now_time_stamp - m_init_time_stamp).count();
-
-    if(elapsed_time > 0) {
-        return (uint64_t)elapsed_time;
-    } else {
-        return 0;
-    }
+    return Clock::elapsed_ns();
 }
 
 bool
 Hal::sleepNs(uint64_t time_ns)
 {
+#ifdef RT_SINGLE_THREADED
+    // there is no maintenance thread, so the clock is re-synchronized by the thread before it sleeps
+    Clock::synchronize();
+#endif
     std::this_thread::sleep_for(std::chrono::nanoseconds(time_ns));
     return true;
 }
 
+bool
+Hal::sleepUntilNs(uint64_t wakeup_time_ns)
+{
+#ifdef RT_SINGLE_THREADED
+    Clock::synchronize();
+#endif
+    const uint64_t wakeup_time = Clock::epoch_ns() + wakeup_time_ns;
+
+    // Clock is expressed in CLOCK_MONOTONIC domain, absolute sleep avoids
+    // the drift introduced by computing the relative time.
+    timespec wakeup_timespec;
+    wakeup_timespec.tv_sec = static_cast<time_t>(wakeup_time / 1000000000ULL);
+    wakeup_timespec.tv_nsec = static_cast<long>(wakeup_time % 1000000000ULL);
+
+    int res;
+    do {
+        res = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeup_timespec, nullptr);
+    } while(res == EINTR);
+
+    return res == 0;
+}
+
 int32_t
 Hal::semaphoreCreate(void)
 {
-    if(m_created_semaphores_count >= RT_MAX_HAL_SEMAPHORES) {
-        return -1;
-    }
-
-    m_created_semaphores_count++;
+    // binary semaphore, as the mutex used previously, so releasing it twice does not let two threads in
+    return createSemaphore(1, 1);
+}
 
-    return (int32_t)m_created_semaphores_count;
+int32_t
+Hal::semaphoreCreateCounting(uint32_t initial_count)
+{
+    return createSemaphore(initial_count, std::numeric_limits<uint32_t>::max());
 }
 
 bool
 Hal::semaphoreObtain(int32_t id)
 {
-    m_semaphores[id].lock();
+    Semaphore* semaphore = getSemaphore(id);
+    if(semaphore == nullptr) {
+        return false;
+    }
+
+    semaphore->obtain();
 
     return true;
 }
 
+bool
+Hal::semaphoreObtainTimeout(int32_t id, uint64_t timeout_ns)
+{
+    Semaphore* semaphore = getSemaphore(id);
+    if(semaphore == nullptr) {
+        return false;
+    }
+
+    return semaphore->obtain(timeout_ns);
+}
+
+bool
+Hal::semaphoreTryObtain(int32_t id)
+{
+    Semaphore* semaphore = getSemaphore(id);
+    if(semaphore == nullptr) {
+        return false;
+    }
+
+    return semaphore->try_obtain();
+}
+
 bool
 Hal::semaphoreRelease(int32_t id)
 {
-    m_semaphores[id].unlock();
+    Semaphore* semaphore = getSemaphore(id);
+    if(semaphore == nullptr) {
+        return false;
+    }
 
-    return true;
+    return semaphore->release();
 }
 
+int32_t
+Hal::createSemaphore(uint32_t initial_count, uint32_t max_count)
+{
+    if(m_created_semaphores_count >= RT_MAX_HAL_SEMAPHORES) {
+        return -1;
+    }
+
+    // IDs start at 1, as generated code may treat 0 as invalid
+    m_semaphores[m_created_semaphores_count].reset(initial_count, max_count);
+    m_created_semaphores_count++;
+    MemoryReport::add(MemoryReport::Category::HalObjects, sizeof(Semaphore));
+
+    return (int32_t)m_created_semaphores_count;
+}
+
+Semaphore*
+Hal::getSemaphore(int32_t id)
+{
+    if(id < 1 || (uint32_t)id > m_created_semaphores_count) {
+        return nullptr;
+    }
+
+    return &m_semaphores[id - 1];
+}
+
+uint32_t Hal::m_created_semaphores_count = 0;
+Semaphore Hal::m_semaphores[RT_MAX_HAL_SEMAPHORES];
+
 } // namespace taste
\ No newline at end of file
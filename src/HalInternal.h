@@ -31,12 +31,16 @@
 #include <cstdbool>
 #include <cstdint>
 #include <cstdlib>
-#include <mutex>
 
+#include "Semaphore.h"
+
+/// Size of the registry of semaphores created by Hal
 #ifndef RT_MAX_HAL_SEMAPHORES
 #define RT_MAX_HAL_SEMAPHORES 8
 #endif
 
+static_assert(RT_MAX_HAL_SEMAPHORES > 0, "RT_MAX_HAL_SEMAPHORES shall be positive");
+
 namespace taste {
 
 class Hal final
@@ -70,14 +74,38 @@ class Hal final
     static bool sleepNs(uint64_t time_ns);
 
     /**
-     * @brief               Creates an RTOS backed semaphore. This function is not
+     * @brief               Suspends the current thread until the given point in time
+     *
+     * @param[in] wakeup_time_ns    time elapsed from the initialization of the
+     *                              runtime, in nanoseconds
+     *
+     * @return              Bool indicating whether the sleep was successful
+     */
+    static bool sleepUntilNs(uint64_t wakeup_time_ns);
+
+    /**
+     * @brief               Creates an RTOS backed binary semaphore, which is
+     *                      initially available. This function is not
      *                      thread safe, but it is assumed to be used only during
      *                      system initialization, from a single thread/Init task.
      *
-     * @return              ID of the created semaphore
+     * @return              ID of the created semaphore, starting at 1, or -1 if
+     *                      RT_MAX_HAL_SEMAPHORES semaphores have been created
      */
     static int32_t semaphoreCreate(void);
 
+    /**
+     * @brief               Creates an RTOS backed counting semaphore. This function
+     *                      is not thread safe, but it is assumed to be used only
+     *                      during system initialization, from a single thread/Init task.
+     *
+     * @param[in] initial_count     initial value of the semaphore counter
+     *
+     * @return              ID of the created semaphore, starting at 1, or -1 if
+     *                      RT_MAX_HAL_SEMAPHORES semaphores have been created
+     */
+    static int32_t semaphoreCreateCounting(uint32_t initial_count);
+
     /**
      * @brief               Obtains the indicated semaphore, suspending the
      *                      execution of the current thread if necessary.
@@ -88,6 +116,28 @@ class Hal final
      */
     static bool semaphoreObtain(int32_t id);
 
+    /**
+     * @brief               Obtains the indicated semaphore, suspending the
+     *                      execution of the current thread at most for the
+     *                      given amount of time.
+     *
+     * @param[in] id        id of the semaphore
+     * @param[in] timeout_ns    maximum waiting time in nanoseconds
+     *
+     * @return              Bool indicating whether the obtain was successful
+     */
+    static bool semaphoreObtainTimeout(int32_t id, uint64_t timeout_ns);
+
+    /**
+     * @brief               Obtains the indicated semaphore if it is available,
+     *                      without suspending the execution of the current thread.
+     *
+     * @param[in] id        id of the semaphore
+     *
+     * @return              Bool indicating whether the obtain was successful
+     */
+    static bool semaphoreTryObtain(int32_t id);
+
     /**
      * @brief               Releases the indicated semaphore, potentially resuming
      *                      threads waiting on the semaphore
@@ -99,10 +149,12 @@ class Hal final
     static bool semaphoreRelease(int32_t id);
 
   private:
-    static std::chrono::steady_clock::time_point m_init_time_stamp;
+    static int32_t createSemaphore(uint32_t initial_count, uint32_t max_count);
+    static Semaphore* getSemaphore(int32_t id);
 
+  private:
     static uint32_t m_created_semaphores_count;
-    static std::mutex m_semaphores[RT_MAX_HAL_SEMAPHORES];
+    static Semaphore m_semaphores[RT_MAX_HAL_SEMAPHORES];
 };
 } // namespace taste
 
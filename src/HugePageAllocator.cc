@@ -0,0 +1,123 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "HugePageAllocator.h"
+
+#include <cstdlib>
+#include <iostream>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace taste {
+namespace {
+size_t
+round_up(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void
+prefault(uint8_t* memory, size_t size)
+{
+    const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    for(size_t offset = 0; offset < size; offset += page_size) {
+        memory[offset] = 0;
+    }
+}
+} // namespace
+
+void*
+HugePageAllocator::allocate(size_t size, size_t alignment)
+{
+    if(alignment == 0 || alignment > RT_HUGE_PAGE_SIZE || (alignment & (alignment - 1)) != 0) {
+        std::cerr << "Invalid alignment of huge page allocation: " << alignment << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if(size >= RT_HUGE_PAGE_SIZE) {
+        return map(round_up(size, RT_HUGE_PAGE_SIZE));
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t offset = round_up(m_arena_used, alignment);
+    if(m_arena == nullptr || offset + size > RT_HUGE_PAGE_SIZE) {
+        // the remaining space of the previous page is abandoned
+        m_arena = map(RT_HUGE_PAGE_SIZE);
+        offset = 0;
+    }
+    m_arena_used = offset + size;
+
+    return m_arena + offset;
+}
+
+void
+HugePageAllocator::deallocate(void* memory, size_t size)
+{
+    if(size >= RT_HUGE_PAGE_SIZE) {
+        munmap(memory, round_up(size, RT_HUGE_PAGE_SIZE));
+    }
+}
+
+uint8_t*
+HugePageAllocator::map(size_t size)
+{
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if(memory != MAP_FAILED) {
+        prefault(static_cast<uint8_t*>(memory), size);
+        return static_cast<uint8_t*>(memory);
+    }
+
+    static std::once_flag warning_flag;
+    std::call_once(warning_flag, []() {
+        std::cerr << "Reserved huge pages are not available, using transparent huge pages" << std::endl;
+    });
+
+    // transparent huge pages require the region to be aligned to the huge page size
+    const size_t mapped_size = size + RT_HUGE_PAGE_SIZE;
+    memory = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(memory == MAP_FAILED) {
+        std::cerr << "Unable to map " << size << " bytes of memory" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    uint8_t* const region = static_cast<uint8_t*>(memory);
+    uint8_t* const aligned = region + round_up(reinterpret_cast<uintptr_t>(region), RT_HUGE_PAGE_SIZE)
+                             - reinterpret_cast<uintptr_t>(region);
+    if(aligned != region) {
+        munmap(region, static_cast<size_t>(aligned - region));
+    }
+    const size_t tail_size = static_cast<size_t>(region + mapped_size - (aligned + size));
+    if(tail_size != 0) {
+        munmap(aligned + size, tail_size);
+    }
+
+    // failure is not fatal, the memory is backed by normal pages then
+    madvise(aligned, size, MADV_HUGEPAGE);
+    prefault(aligned, size);
+
+    return aligned;
+}
+
+std::mutex HugePageAllocator::m_mutex;
+uint8_t* HugePageAllocator::m_arena = nullptr;
+size_t HugePageAllocator::m_arena_used = 0;
+} // namespace taste
@@ -0,0 +1,108 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_HUGE_PAGE_ALLOCATOR_H
+#define TASTE_HUGE_PAGE_ALLOCATOR_H
+
+/**
+ * @file    HugePageAllocator.h
+ * @brief   Allocator of runtime-owned memory backed by huge pages.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#ifndef RT_HUGE_PAGE_SIZE
+#define RT_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#endif
+
+namespace taste {
+/**
+ * @brief Allocator of memory used by queues.
+ *
+ * If RT_USE_HUGE_PAGES is defined, the memory is backed by huge pages.
+ * Pages from the reserved pool (MAP_HUGETLB) are used if available,
+ * otherwise a region aligned to the huge page size is advised to be backed
+ * by transparent huge pages, which falls back to normal pages if the kernel
+ * cannot provide them. The memory is prefaulted during allocation.
+ *
+ * Allocations smaller than RT_HUGE_PAGE_SIZE are packed together into shared
+ * huge pages and are not returned to the system, as runtime objects live
+ * for the whole program. Larger allocations use separate mappings.
+ *
+ * If RT_USE_HUGE_PAGES is not defined, the standard allocator is used.
+ */
+class HugePageAllocator final
+{
+  public:
+    /**
+     * @brief Deleted default constructor.
+     */
+    HugePageAllocator() = delete;
+
+    /**
+     * @brief Check if huge pages are used.
+     *
+     * @return true if RT_USE_HUGE_PAGES is defined, otherwise false
+     */
+    static constexpr bool is_enabled()
+    {
+#ifdef RT_USE_HUGE_PAGES
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Allocate memory backed by huge pages.
+     *
+     * Terminates the program if the memory cannot be allocated.
+     *
+     * @param size       size of the memory in bytes
+     * @param alignment  alignment of the memory, up to RT_HUGE_PAGE_SIZE
+     *
+     * @return pointer to the allocated memory
+     */
+    static void* allocate(size_t size, size_t alignment);
+
+    /**
+     * @brief Release memory obtained using allocate.
+     *
+     * @param memory   pointer to the memory
+     * @param size     size of the memory passed to allocate
+     */
+    static void deallocate(void* memory, size_t size);
+
+  private:
+    static uint8_t* map(size_t size);
+
+  private:
+    static std::mutex m_mutex;
+    static uint8_t* m_arena;
+    static size_t m_arena_used;
+};
+
+} // namespace taste
+
+#endif
@@ -22,16 +22,223 @@
 
 #include "Lock.h"
 
+#if(defined(RT_LOCK_PROFILING) || defined(RT_ENABLE_METRICS)) && !defined(RT_SINGLE_THREADED)
+#include "Clock.h"
+#endif
+
+#include <cstdlib>
+#include <iostream>
+
+#include <sched.h>
+
 namespace taste {
+#ifndef RT_SINGLE_THREADED
+namespace {
+/// Owner priority of a lock, which was not raised to the priority ceiling
+constexpr int NOT_RAISED = -1;
+
+inline void
+cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+} // namespace
+#endif
+
+Lock::Lock()
+    : Lock(nullptr)
+{
+}
+
+Lock::Lock(const Policy policy, const int priority_ceiling)
+    : Lock(nullptr, policy, priority_ceiling)
+{
+}
+
+#ifdef RT_SINGLE_THREADED
+Lock::Lock(const char* name, const Policy policy, const int priority_ceiling)
+    : m_name(name)
+    , m_policy(policy)
+{
+    (void)priority_ceiling;
+}
+
+Lock::~Lock() = default;
+#else
+Lock::Lock(const char* name, const Policy policy, const int priority_ceiling)
+    : m_name(name)
+    , m_policy(policy)
+    , m_priority_ceiling(priority_ceiling)
+    , m_owner_priority(NOT_RAISED)
+#ifdef RT_LOCK_PROFILING
+    , m_statistics(name, this)
+#endif
+#ifdef RT_ENABLE_METRICS
+    , m_metrics(Metrics::register_lock(name))
+#endif
+{
+    pthread_mutexattr_t attributes;
+    int res = pthread_mutexattr_init(&attributes);
+    if(res != 0) {
+        std::cerr << "Unable to initialize lock attributes" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    switch(policy) {
+        case Policy::PriorityInheritance:
+        case Policy::PriorityCeiling:
+            // the ceiling is applied by raising the priority of the owner, see raise_to_ceiling
+            if(priority_ceiling < sched_get_priority_min(SCHED_FIFO)
+               || priority_ceiling > sched_get_priority_max(SCHED_FIFO)) {
+                std::cerr << "Invalid lock priority ceiling " << priority_ceiling << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            res = pthread_mutexattr_setprotocol(&attributes, PTHREAD_PRIO_INHERIT);
+            break;
+        case Policy::None:
+        case Policy::AdaptiveSpin:
+            break;
+    }
+    if(res != 0) {
+        std::cerr << "Unable to set locking protocol in lock attributes" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    res = pthread_mutex_init(&m_mutex, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+    if(res != 0) {
+        std::cerr << "Unable to initialize lock" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+Lock::~Lock()
+{
+#ifdef RT_ENABLE_METRICS
+    Metrics::unregister_lock(m_metrics);
+#endif
+    pthread_mutex_destroy(&m_mutex);
+}
+
 void
 Lock::lock()
 {
-    m_mutex.lock();
+    const int owner_priority = raise_to_ceiling();
+#if defined(RT_LOCK_PROFILING) || defined(RT_ENABLE_METRICS)
+    if(pthread_mutex_trylock(&m_mutex) == 0) {
+        m_owner_priority = owner_priority;
+        record_acquisition(0);
+        return;
+    }
+
+    const uint64_t wait_start_ns = Clock::now_ns();
+    acquire();
+    m_owner_priority = owner_priority;
+    record_acquisition(wait_start_ns);
+#else
+    acquire();
+    m_owner_priority = owner_priority;
+#endif
 }
 
 void
 Lock::unlock()
 {
-    m_mutex.unlock();
+#ifdef RT_LOCK_PROFILING
+    m_statistics.record_release(Clock::now_ns());
+#endif
+    const int owner_priority = m_owner_priority;
+    pthread_mutex_unlock(&m_mutex);
+    restore_priority(owner_priority);
+}
+#endif
+
+Lock::Policy
+Lock::policy() const
+{
+    return m_policy;
+}
+
+const char*
+Lock::name() const
+{
+    return m_name;
+}
+
+#ifndef RT_SINGLE_THREADED
+void
+Lock::record_acquisition(uint64_t wait_start_ns)
+{
+    // called by the owner of the lock, zero wait_start_ns denotes uncontended acquisition
+#ifdef RT_LOCK_PROFILING
+    const uint64_t now_ns = Clock::now_ns();
+    if(wait_start_ns == 0) {
+        m_statistics.record_acquisition(now_ns);
+    } else {
+        m_statistics.record_contended_acquisition(now_ns, now_ns - wait_start_ns);
+    }
+#endif
+#ifdef RT_ENABLE_METRICS
+    if(m_metrics != nullptr) {
+        Metrics::add(m_metrics->acquisitions);
+        if(wait_start_ns != 0) {
+            Metrics::add(m_metrics->contended_acquisitions);
+            Metrics::add(m_metrics->wait_time_ns, Clock::now_ns() - wait_start_ns);
+        }
+    }
+#endif
+}
+
+void
+Lock::acquire()
+{
+    if(m_policy == Policy::AdaptiveSpin) {
+        for(int i = 0; i < RT_LOCK_ADAPTIVE_SPIN_COUNT; ++i) {
+            if(pthread_mutex_trylock(&m_mutex) == 0) {
+                return;
+            }
+            cpu_relax();
+        }
+    }
+
+    const int res = pthread_mutex_lock(&m_mutex);
+    if(res != 0) {
+        // e.g. the lock is already held by the calling thread
+        std::cerr << "Unable to acquire lock. Error code : " << res << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+int
+Lock::raise_to_ceiling() const
+{
+    if(m_policy != Policy::PriorityCeiling) {
+        return NOT_RAISED;
+    }
+
+    int policy = SCHED_OTHER;
+    sched_param parameters{};
+    if(pthread_getschedparam(pthread_self(), &policy, &parameters) != 0
+       || (policy != SCHED_FIFO && policy != SCHED_RR) || parameters.sched_priority >= m_priority_ceiling) {
+        return NOT_RAISED;
+    }
+    if(pthread_setschedprio(pthread_self(), m_priority_ceiling) != 0) {
+        // not permitted to raise the priority, fall back to priority inheritance
+        return NOT_RAISED;
+    }
+    return parameters.sched_priority;
+}
+
+void
+Lock::restore_priority(const int priority)
+{
+    if(priority != NOT_RAISED) {
+        pthread_setschedprio(pthread_self(), priority);
+    }
 }
+#endif
 } // namespace taste
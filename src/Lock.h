@@ -29,21 +29,103 @@
  *
  */
 
-#include <mutex>
+#include <cstdint>
+#include <pthread.h>
+
+#ifdef RT_LOCK_PROFILING
+#include "LockStatistics.h"
+#endif
+
+#if defined(RT_ENABLE_METRICS) && !defined(RT_SINGLE_THREADED)
+#include "Metrics.h"
+#endif
+
+/// Policy used by default constructed locks, name of Lock::Policy enumerator
+#ifndef RT_DEFAULT_LOCK_POLICY
+#define RT_DEFAULT_LOCK_POLICY None
+#endif
+
+/// Priority ceiling used by default constructed locks with PriorityCeiling policy
+#ifndef RT_DEFAULT_LOCK_PRIORITY_CEILING
+#define RT_DEFAULT_LOCK_PRIORITY_CEILING 99
+#endif
+
+/// Number of attempts to acquire lock before blocking with AdaptiveSpin policy
+#ifndef RT_LOCK_ADAPTIVE_SPIN_COUNT
+#define RT_LOCK_ADAPTIVE_SPIN_COUNT 100
+#endif
 
 namespace taste {
 /**
  * @brief Concurrency Lock implementation
+ *
+ * When RT_LOCK_PROFILING is defined, each lock collects contention
+ * statistics, which can be printed using LockStatistics::print_all.
+ *
+ * PriorityCeiling locks are priority inheritance mutexes, which raise
+ * the priority of a SCHED_FIFO or SCHED_RR owner to the ceiling for as long
+ * as the lock is held. The lock shall be taken by such threads only when
+ * their priority does not exceed the ceiling, and nested PriorityCeiling
+ * locks shall be released in reverse order of acquisition. Callers with
+ * a different scheduling policy, e.g. the main thread during initialization,
+ * or callers not permitted to raise their priority, are not raised
+ * and get priority inheritance only.
+ *
+ * When RT_SINGLE_THREADED is defined, the lock does not synchronize,
+ * acquiring and releasing it compiles to nothing and no statistics
+ * are collected.
  */
 class Lock final
 {
   public:
+    /**
+     * @brief Locking policy
+     */
+    enum class Policy
+    {
+        /// Plain mutex
+        None,
+        /// Owner inherits priority of the highest priority waiting thread (PTHREAD_PRIO_INHERIT)
+        PriorityInheritance,
+        /// Owner scheduled with SCHED_FIFO or SCHED_RR runs with the priority ceiling of the lock,
+        /// other owners, e.g. initialization code, get priority inheritance only (see Lock)
+        PriorityCeiling,
+        /// Spin for RT_LOCK_ADAPTIVE_SPIN_COUNT attempts before blocking
+        AdaptiveSpin
+    };
+
     /**
      * @brief Default constructor.
      *
+     * Constructed lock is in 'unlocked' state and uses RT_DEFAULT_LOCK_POLICY.
+     */
+    Lock();
+
+    /**
+     * @brief Constructor.
+     *
      * Constructed lock is in 'unlocked' state.
+     *
+     * @param policy            locking policy
+     * @param priority_ceiling  priority ceiling, used only with PriorityCeiling policy
      */
-    Lock() = default;
+    explicit Lock(const Policy policy, const int priority_ceiling = RT_DEFAULT_LOCK_PRIORITY_CEILING);
+
+    /**
+     * @brief Constructor.
+     *
+     * Constructed lock is in 'unlocked' state.
+     *
+     * @param name              name of the lock used in statistics, e.g. protected function name
+     * @param policy            locking policy
+     * @param priority_ceiling  priority ceiling, used only with PriorityCeiling policy
+     */
+    explicit Lock(const char* name,
+                  const Policy policy = Policy::RT_DEFAULT_LOCK_POLICY,
+                  const int priority_ceiling = RT_DEFAULT_LOCK_PRIORITY_CEILING);
+
+    /// @brief destructor
+    ~Lock();
 
     /// @brief deleted copy constructor
     Lock(const Lock&) = delete;
@@ -62,9 +144,55 @@ class Lock final
     /// @brief release lock
     void unlock();
 
+    /**
+     * @brief get the locking policy
+     *
+     * @return locking policy
+     */
+    Policy policy() const;
+
+    /**
+     * @brief get the name of the lock
+     *
+     * @return name of the lock, nullptr if not set
+     */
+    const char* name() const;
+
+#ifndef RT_SINGLE_THREADED
   private:
-    std::mutex m_mutex;
+    void acquire();
+    void record_acquisition(uint64_t wait_start_ns);
+    int raise_to_ceiling() const;
+    static void restore_priority(int priority);
+#endif
+
+  private:
+    const char* m_name;
+    const Policy m_policy;
+#ifndef RT_SINGLE_THREADED
+    pthread_mutex_t m_mutex;
+    const int m_priority_ceiling;
+    int m_owner_priority;
+#ifdef RT_LOCK_PROFILING
+    LockStatistics m_statistics;
+#endif
+#ifdef RT_ENABLE_METRICS
+    LockMetrics* const m_metrics;
+#endif
+#endif
 };
+
+#ifdef RT_SINGLE_THREADED
+inline void
+Lock::lock()
+{
+}
+
+inline void
+Lock::unlock()
+{
+}
+#endif
 } // namespace taste
 
 #endif
@@ -0,0 +1,223 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LockStatistics.h"
+
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace taste {
+namespace {
+struct Registry
+{
+    std::mutex mutex;
+    LockStatistics* head = nullptr;
+    std::vector<LockStatistics::Summary> retired;
+
+    ~Registry()
+    {
+#ifdef RT_LOCK_PROFILING_DUMP_AT_EXIT
+        LockStatistics::print_all(std::cerr);
+#endif
+    }
+};
+
+Registry&
+registry()
+{
+    // constructed by the first lock, therefore destroyed after all static locks
+    static Registry instance;
+    return instance;
+}
+
+int32_t
+current_thread_id()
+{
+    thread_local const int32_t thread_id = static_cast<int32_t>(syscall(SYS_gettid));
+    return thread_id;
+}
+
+void
+print_histogram(std::ostream& stream, const char* title, const LockStatistics::Histogram& histogram)
+{
+    stream << "    " << title << ":";
+    for(size_t i = 0; i < histogram.size(); ++i) {
+        if(histogram[i] != 0) {
+            stream << " <" << (1ULL << i) << "ns:" << histogram[i];
+        }
+    }
+    stream << std::endl;
+}
+} // namespace
+
+LockStatistics::LockStatistics(const char* name, const void* address)
+    : m_name(name)
+    , m_address(address)
+    , m_acquisition_time_ns(0)
+    , m_acquisitions(0)
+    , m_contended_acquisitions(0)
+    , m_total_wait_time_ns(0)
+    , m_max_wait_time_ns(0)
+    , m_total_hold_time_ns(0)
+    , m_max_hold_time_ns(0)
+    , m_wait_time_histogram()
+    , m_hold_time_histogram()
+    , m_waiter_ids()
+    , m_waiter_counts()
+    , m_previous(nullptr)
+{
+    Registry& instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    m_next = instance.head;
+    if(m_next != nullptr) {
+        m_next->m_previous = this;
+    }
+    instance.head = this;
+}
+
+LockStatistics::~LockStatistics()
+{
+    Registry& instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    if(m_acquisitions.load(std::memory_order_relaxed) != 0) {
+        instance.retired.push_back(summary());
+    }
+    if(m_previous != nullptr) {
+        m_previous->m_next = m_next;
+    } else {
+        instance.head = m_next;
+    }
+    if(m_next != nullptr) {
+        m_next->m_previous = m_previous;
+    }
+}
+
+void
+LockStatistics::record_contended_acquisition(uint64_t now_ns, uint64_t wait_time_ns)
+{
+    record_acquisition(now_ns);
+    increment(m_contended_acquisitions);
+    increment(m_total_wait_time_ns, wait_time_ns);
+    update_maximum(m_max_wait_time_ns, wait_time_ns);
+    record_in_histogram(m_wait_time_histogram, wait_time_ns);
+    record_waiter();
+}
+
+void
+LockStatistics::record_waiter()
+{
+    // Space-saving algorithm, approximates the most frequent waiters
+    // using a fixed number of counters
+    const int32_t thread_id = current_thread_id();
+    size_t minimum_index = 0;
+    for(size_t i = 0; i < m_waiter_ids.size(); ++i) {
+        const int32_t id = m_waiter_ids[i].load(std::memory_order_relaxed);
+        if(id == thread_id || id == 0) {
+            m_waiter_ids[i].store(thread_id, std::memory_order_relaxed);
+            increment(m_waiter_counts[i]);
+            return;
+        }
+        if(m_waiter_counts[i].load(std::memory_order_relaxed)
+           < m_waiter_counts[minimum_index].load(std::memory_order_relaxed)) {
+            minimum_index = i;
+        }
+    }
+    m_waiter_ids[minimum_index].store(thread_id, std::memory_order_relaxed);
+    increment(m_waiter_counts[minimum_index]);
+}
+
+LockStatistics::Summary
+LockStatistics::summary() const
+{
+    Summary result;
+    result.name = m_name;
+    result.address = m_address;
+    result.acquisitions = m_acquisitions.load(std::memory_order_relaxed);
+    result.contended_acquisitions = m_contended_acquisitions.load(std::memory_order_relaxed);
+    result.total_wait_time_ns = m_total_wait_time_ns.load(std::memory_order_relaxed);
+    result.max_wait_time_ns = m_max_wait_time_ns.load(std::memory_order_relaxed);
+    result.total_hold_time_ns = m_total_hold_time_ns.load(std::memory_order_relaxed);
+    result.max_hold_time_ns = m_max_hold_time_ns.load(std::memory_order_relaxed);
+    for(size_t i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        result.wait_time_histogram[i] = m_wait_time_histogram[i].load(std::memory_order_relaxed);
+        result.hold_time_histogram[i] = m_hold_time_histogram[i].load(std::memory_order_relaxed);
+    }
+    for(size_t i = 0; i < result.top_waiters.size(); ++i) {
+        result.top_waiters[i].thread_id = m_waiter_ids[i].load(std::memory_order_relaxed);
+        result.top_waiters[i].count = m_waiter_counts[i].load(std::memory_order_relaxed);
+    }
+    std::sort(result.top_waiters.begin(), result.top_waiters.end(), [](const Waiter& lhs, const Waiter& rhs) {
+        return lhs.count > rhs.count;
+    });
+
+    return result;
+}
+
+void
+LockStatistics::print_all(std::ostream& stream)
+{
+    std::vector<Summary> summaries;
+    {
+        Registry& instance = registry();
+        std::lock_guard<std::mutex> lock(instance.mutex);
+        summaries = instance.retired;
+        for(const LockStatistics* statistics = instance.head; statistics != nullptr;
+            statistics = statistics->m_next) {
+            summaries.push_back(statistics->summary());
+        }
+    }
+
+    std::sort(summaries.begin(), summaries.end(), [](const Summary& lhs, const Summary& rhs) {
+        return lhs.total_wait_time_ns > rhs.total_wait_time_ns;
+    });
+
+    stream << "Lock statistics (" << summaries.size() << " locks):" << std::endl;
+    for(const Summary& summary : summaries) {
+        if(summary.acquisitions == 0) {
+            continue;
+        }
+        stream << "  " << (summary.name != nullptr ? summary.name : "<unnamed>") << " (" << summary.address
+               << "): acquisitions " << summary.acquisitions << ", contended " << summary.contended_acquisitions
+               << ", wait total " << summary.total_wait_time_ns << "ns max " << summary.max_wait_time_ns
+               << "ns, hold total " << summary.total_hold_time_ns << "ns max " << summary.max_hold_time_ns << "ns"
+               << std::endl;
+        if(summary.contended_acquisitions != 0) {
+            print_histogram(stream, "wait", summary.wait_time_histogram);
+        }
+        print_histogram(stream, "hold", summary.hold_time_histogram);
+        if(summary.contended_acquisitions != 0) {
+            stream << "    top waiters:";
+            for(const Waiter& waiter : summary.top_waiters) {
+                if(waiter.thread_id != 0) {
+                    stream << " tid " << waiter.thread_id << ":" << waiter.count;
+                }
+            }
+            stream << std::endl;
+        }
+    }
+}
+} // namespace taste
@@ -0,0 +1,224 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_LOCK_STATISTICS_H
+#define TASTE_LOCK_STATISTICS_H
+
+/**
+ * @file    LockStatistics.h
+ * @brief   Contention statistics of taste::Lock.
+ */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+/// Number of tracked threads waiting for the lock
+#ifndef RT_LOCK_STATISTICS_TOP_WAITERS
+#define RT_LOCK_STATISTICS_TOP_WAITERS 8
+#endif
+
+namespace taste {
+/**
+ * @brief Contention statistics of single lock.
+ *
+ * All record functions shall be called by the owner of the lock,
+ * therefore the statistics are updated without read-modify-write operations.
+ * The statistics can be printed at any time from any thread.
+ * The statistics of all locks are printed at exit if RT_LOCK_PROFILING_DUMP_AT_EXIT
+ * is defined.
+ */
+class LockStatistics final
+{
+  public:
+    /// Number of histogram buckets, bucket n counts durations in [2^(n-1), 2^n) ns
+    static constexpr size_t HISTOGRAM_BUCKETS = 40;
+
+    /// Type of wait and hold time histograms
+    using Histogram = std::array<uint64_t, HISTOGRAM_BUCKETS>;
+
+    /// Number of waits of single thread
+    struct Waiter
+    {
+        /// Thread ID, 0 if unused
+        int32_t thread_id;
+        /// Approximate number of contended acquisitions
+        uint64_t count;
+    };
+
+    /// Copy of the statistics
+    struct Summary
+    {
+        /// Name of the lock
+        const char* name;
+        /// Address of the lock
+        const void* address;
+        /// Number of acquisitions
+        uint64_t acquisitions;
+        /// Number of acquisitions which had to wait for the lock
+        uint64_t contended_acquisitions;
+        /// Total time spent waiting for the lock
+        uint64_t total_wait_time_ns;
+        /// Maximum time spent waiting for the lock
+        uint64_t max_wait_time_ns;
+        /// Total time the lock was held
+        uint64_t total_hold_time_ns;
+        /// Maximum time the lock was held
+        uint64_t max_hold_time_ns;
+        /// Wait time histogram of contended acquisitions
+        Histogram wait_time_histogram;
+        /// Hold time histogram
+        Histogram hold_time_histogram;
+        /// Threads which waited most often
+        std::array<Waiter, RT_LOCK_STATISTICS_TOP_WAITERS> top_waiters;
+    };
+
+    /**
+     * @brief Constructor
+     *
+     * Registers statistics in the global registry.
+     *
+     * @param name      name of the lock, may be nullptr
+     * @param address   address of the lock
+     */
+    LockStatistics(const char* name, const void* address);
+
+    /// @brief destructor, keeps copy of statistics for the final report
+    ~LockStatistics();
+
+    /// @brief deleted copy constructor
+    LockStatistics(const LockStatistics&) = delete;
+
+    /// @brief deleted move constructor
+    LockStatistics(LockStatistics&&) = delete;
+
+    /// @brief deleted copy assignment operator
+    LockStatistics& operator=(const LockStatistics&) = delete;
+
+    /// @brief deleted move assignment operator
+    LockStatistics& operator=(LockStatistics&&) = delete;
+
+    /**
+     * @brief Record acquisition which did not wait for the lock.
+     *
+     * @param now_ns    time of acquisition
+     */
+    void record_acquisition(uint64_t now_ns);
+
+    /**
+     * @brief Record acquisition which waited for the lock.
+     *
+     * @param now_ns        time of acquisition
+     * @param wait_time_ns  time spent waiting
+     */
+    void record_contended_acquisition(uint64_t now_ns, uint64_t wait_time_ns);
+
+    /**
+     * @brief Record release of the lock.
+     *
+     * @param now_ns    time of release
+     */
+    void record_release(uint64_t now_ns);
+
+    /**
+     * @brief Copy the statistics.
+     *
+     * @return summary of the statistics
+     */
+    Summary summary() const;
+
+    /**
+     * @brief Print statistics of all locks, most contended first.
+     *
+     * @param stream   output stream
+     */
+    static void print_all(std::ostream& stream);
+
+  private:
+    using AtomicHistogram = std::array<std::atomic<uint64_t>, HISTOGRAM_BUCKETS>;
+
+    static void increment(std::atomic<uint64_t>& counter, uint64_t value = 1);
+    static void update_maximum(std::atomic<uint64_t>& maximum, uint64_t value);
+    static void record_in_histogram(AtomicHistogram& histogram, uint64_t value);
+    void record_waiter();
+
+  private:
+    const char* m_name;
+    const void* m_address;
+    uint64_t m_acquisition_time_ns;
+
+    std::atomic<uint64_t> m_acquisitions;
+    std::atomic<uint64_t> m_contended_acquisitions;
+    std::atomic<uint64_t> m_total_wait_time_ns;
+    std::atomic<uint64_t> m_max_wait_time_ns;
+    std::atomic<uint64_t> m_total_hold_time_ns;
+    std::atomic<uint64_t> m_max_hold_time_ns;
+    AtomicHistogram m_wait_time_histogram;
+    AtomicHistogram m_hold_time_histogram;
+    std::array<std::atomic<int32_t>, RT_LOCK_STATISTICS_TOP_WAITERS> m_waiter_ids;
+    std::array<std::atomic<uint64_t>, RT_LOCK_STATISTICS_TOP_WAITERS> m_waiter_counts;
+
+    LockStatistics* m_previous;
+    LockStatistics* m_next;
+};
+
+inline void
+LockStatistics::increment(std::atomic<uint64_t>& counter, uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+inline void
+LockStatistics::update_maximum(std::atomic<uint64_t>& maximum, uint64_t value)
+{
+    if(value > maximum.load(std::memory_order_relaxed)) {
+        maximum.store(value, std::memory_order_relaxed);
+    }
+}
+
+inline void
+LockStatistics::record_in_histogram(AtomicHistogram& histogram, uint64_t value)
+{
+    const size_t bucket = value == 0 ? 0 : static_cast<size_t>(64 - __builtin_clzll(value));
+    increment(histogram[bucket < HISTOGRAM_BUCKETS ? bucket : HISTOGRAM_BUCKETS - 1]);
+}
+
+inline void
+LockStatistics::record_acquisition(uint64_t now_ns)
+{
+    m_acquisition_time_ns = now_ns;
+    increment(m_acquisitions);
+}
+
+inline void
+LockStatistics::record_release(uint64_t now_ns)
+{
+    const uint64_t hold_time_ns = now_ns - m_acquisition_time_ns;
+    increment(m_total_hold_time_ns, hold_time_ns);
+    update_maximum(m_max_hold_time_ns, hold_time_ns);
+    record_in_histogram(m_hold_time_histogram, hold_time_ns);
+}
+} // namespace taste
+
+#endif
@@ -0,0 +1,130 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MemoryReport.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace taste {
+namespace {
+const char* const CATEGORY_NAMES[] = { "queue storage", "thread stacks", "Hal objects" };
+
+void
+print_resident_set(std::ostream& stream)
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while(std::getline(status, line)) {
+        if(line.compare(0, 6, "VmRSS:") == 0 || line.compare(0, 6, "VmHWM:") == 0) {
+            stream << "  " << line << std::endl;
+        }
+    }
+}
+} // namespace
+
+void
+MemoryReport::add(Category category, size_t size)
+{
+    m_totals[static_cast<size_t>(category)].fetch_add(size, std::memory_order_relaxed);
+}
+
+void
+MemoryReport::remove(Category category, size_t size)
+{
+    m_totals[static_cast<size_t>(category)].fetch_sub(size, std::memory_order_relaxed);
+}
+
+size_t
+MemoryReport::total(Category category)
+{
+    return m_totals[static_cast<size_t>(category)].load(std::memory_order_relaxed);
+}
+
+void
+MemoryReport::register_stack(const char* name, uint8_t* stack, size_t size)
+{
+    memset(stack, RT_STACK_PAINT_PATTERN, size);
+
+    const size_t index = m_stack_count.fetch_add(1);
+    if(index >= RT_MEMORY_REPORT_MAX_STACKS) {
+        // the stack is still painted, but it is not reported
+        m_stack_count.fetch_sub(1);
+        return;
+    }
+    m_stacks[index].name = name;
+    m_stacks[index].stack = stack;
+    m_stacks[index].size = size;
+}
+
+size_t
+MemoryReport::stack_high_water_mark(const uint8_t* stack, size_t size)
+{
+    size_t unused = 0;
+    while(unused < size && stack[unused] == RT_STACK_PAINT_PATTERN) {
+        ++unused;
+    }
+    return size - unused;
+}
+
+void
+MemoryReport::print(std::ostream& stream, const char* title)
+{
+    stream << title << ":" << std::endl;
+    for(size_t category = 0; category < static_cast<size_t>(Category::Count); ++category) {
+        stream << "  " << CATEGORY_NAMES[category] << ": " << m_totals[category].load(std::memory_order_relaxed)
+               << " bytes" << std::endl;
+    }
+    print_resident_set(stream);
+
+    const size_t stack_count = std::min<size_t>(m_stack_count.load(), RT_MEMORY_REPORT_MAX_STACKS);
+    if(stack_count == 0) {
+        return;
+    }
+    stream << "  peak stack usage:" << std::endl;
+    for(size_t i = 0; i < stack_count; ++i) {
+        const StackEntry& entry = m_stacks[i];
+        const size_t used = stack_high_water_mark(entry.stack, entry.size);
+        stream << "    " << (entry.name != nullptr ? entry.name : "thread") << ": " << used << " of " << entry.size
+               << " bytes (" << used * 100 / entry.size << "%)" << std::endl;
+    }
+}
+
+void
+MemoryReport::print_at_startup_and_exit()
+{
+    print(std::cerr, "Memory footprint after startup");
+
+    // the runtime may also be terminated using quick_exit
+    static const auto print_at_exit = []() { print(std::cerr, "Memory footprint at exit"); };
+    atexit(print_at_exit);
+    at_quick_exit(print_at_exit);
+}
+
+std::atomic<size_t> MemoryReport::m_totals[static_cast<size_t>(Category::Count)];
+MemoryReport::StackEntry MemoryReport::m_stacks[RT_MEMORY_REPORT_MAX_STACKS];
+std::atomic<size_t> MemoryReport::m_stack_count(0);
+} // namespace taste
@@ -0,0 +1,169 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_MEMORY_REPORT_H
+#define TASTE_MEMORY_REPORT_H
+
+/**
+ * @file    MemoryReport.h
+ * @brief   Memory footprint of the runtime and stack usage of threads.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#ifndef RT_MEMORY_REPORT_MAX_STACKS
+#define RT_MEMORY_REPORT_MAX_STACKS 128
+#endif
+
+#ifndef RT_STACK_PAINT_PATTERN
+#define RT_STACK_PAINT_PATTERN 0xA5
+#endif
+
+namespace taste {
+/**
+ * @brief Accounting of memory owned by the runtime.
+ *
+ * Sizes of queue storage, thread stacks and Hal objects are always counted,
+ * which is done only when these objects are created.
+ *
+ * If RT_MEMORY_REPORT is defined, thread stacks are allocated by Thread
+ * and painted with RT_STACK_PAINT_PATTERN, so the peak stack usage
+ * of each thread can be measured. The report is printed on the standard error
+ * after the initialization finished in StartBarrier and at exit.
+ * Painting touches all pages of stacks, so it shall be used to measure
+ * stack usage, not in the deployed configuration.
+ */
+class MemoryReport final
+{
+  public:
+    /**
+     * @brief Category of runtime-owned memory
+     */
+    enum class Category
+    {
+        QueueStorage,
+        ThreadStacks,
+        HalObjects,
+        Count
+    };
+
+    /**
+     * @brief Deleted default constructor.
+     */
+    MemoryReport() = delete;
+
+    /**
+     * @brief Check if stacks are painted and the report is printed.
+     *
+     * @return true if RT_MEMORY_REPORT is defined, otherwise false
+     */
+    static constexpr bool is_enabled()
+    {
+#ifdef RT_MEMORY_REPORT
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Account allocated memory.
+     *
+     * @param category  category of the memory
+     * @param size      size in bytes
+     */
+    static void add(Category category, size_t size);
+
+    /**
+     * @brief Account released memory.
+     *
+     * @param category  category of the memory
+     * @param size      size in bytes
+     */
+    static void remove(Category category, size_t size);
+
+    /**
+     * @brief Get amount of memory in the category.
+     *
+     * @param category  category of the memory
+     *
+     * @return size in bytes
+     */
+    static size_t total(Category category);
+
+    /**
+     * @brief Paint the stack and register it for the report.
+     *
+     * Shall be called before the stack is used by the thread.
+     *
+     * @param name      name of the thread, may be nullptr
+     * @param stack     lowest address of the stack
+     * @param size      size of the stack in bytes
+     */
+    static void register_stack(const char* name, uint8_t* stack, size_t size);
+
+    /**
+     * @brief Measure the peak usage of a painted stack.
+     *
+     * The stack grows down, so the usage is the distance from the top
+     * to the lowest byte which is not equal to the pattern.
+     *
+     * @param stack     lowest address of the stack
+     * @param size      size of the stack in bytes
+     *
+     * @return peak stack usage in bytes
+     */
+    static size_t stack_high_water_mark(const uint8_t* stack, size_t size);
+
+    /**
+     * @brief Print the memory footprint and stack usage of threads.
+     *
+     * @param stream    output stream
+     * @param title     title of the report
+     */
+    static void print(std::ostream& stream, const char* title);
+
+    /**
+     * @brief Print the report now and at exit.
+     *
+     * Called by StartBarrier if RT_MEMORY_REPORT is defined.
+     */
+    static void print_at_startup_and_exit();
+
+  private:
+    struct StackEntry
+    {
+        const char* name;
+        const uint8_t* stack;
+        size_t size;
+    };
+
+    static std::atomic<size_t> m_totals[static_cast<size_t>(Category::Count)];
+    static StackEntry m_stacks[RT_MEMORY_REPORT_MAX_STACKS];
+    static std::atomic<size_t> m_stack_count;
+};
+} // namespace taste
+
+#endif
@@ -0,0 +1,236 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Metrics.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace taste {
+namespace {
+std::once_flag metrics_initialization_flag;
+MetricsBlock* metrics_block = nullptr;
+char metrics_segment_name[64];
+
+void
+remove_segment()
+{
+    shm_unlink(metrics_segment_name);
+}
+
+MetricsBlock*
+map_block()
+{
+    snprintf(metrics_segment_name, sizeof(metrics_segment_name), "%s%d", RT_METRICS_SHM_PREFIX, getpid());
+
+    void* memory = MAP_FAILED;
+    const int descriptor = shm_open(metrics_segment_name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if(descriptor >= 0) {
+        if(ftruncate(descriptor, sizeof(MetricsBlock)) == 0) {
+            memory = mmap(nullptr, sizeof(MetricsBlock), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+        }
+        close(descriptor);
+    }
+
+    if(memory == MAP_FAILED) {
+        // metrics are still collected, but are not visible outside the process
+        std::cerr << "Unable to create metrics shared memory segment '" << metrics_segment_name << "'" << std::endl;
+        memory = mmap(nullptr, sizeof(MetricsBlock), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(memory == MAP_FAILED) {
+            std::cerr << "Unable to allocate metrics block" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        atexit(remove_segment);
+        at_quick_exit(remove_segment);
+    }
+
+    // the memory is zero-initialized, which is a valid state of atomics
+    MetricsBlock* block = static_cast<MetricsBlock*>(memory);
+    block->size = sizeof(MetricsBlock);
+    block->process_id = getpid();
+    block->version = METRICS_VERSION;
+    std::atomic_thread_fence(std::memory_order_release);
+    block->magic = METRICS_MAGIC;
+
+    return block;
+}
+
+void
+copy_name(char* destination, const char* name, const char* default_name, uint32_t index)
+{
+    if(name != nullptr) {
+        strncpy(destination, name, METRICS_NAME_LENGTH - 1);
+    } else {
+        snprintf(destination, METRICS_NAME_LENGTH, "%s-%u", default_name, index);
+    }
+}
+
+/// Claims entry which is free, returns false if it is used
+template<typename T>
+bool
+claim(T& entry)
+{
+    uint32_t state = METRICS_ENTRY_FREE;
+    return entry.state.compare_exchange_strong(
+            state, METRICS_ENTRY_INITIALIZING, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+/// Reserves entry in the table, reusing freed entries, returns nullptr when the table is full
+template<typename T, size_t N>
+T*
+reserve(std::atomic<uint32_t>& count, T (&entries)[N], uint32_t& index)
+{
+    const uint32_t used = count.load(std::memory_order_relaxed);
+    for(index = 0; index < used && index < N; ++index) {
+        if(claim(entries[index])) {
+            return &entries[index];
+        }
+    }
+
+    index = count.load(std::memory_order_relaxed);
+    while(true) {
+        if(index >= N) {
+            return nullptr;
+        }
+        if(count.compare_exchange_weak(index, index + 1, std::memory_order_relaxed)) {
+            // another registration may have claimed the entry while scanning for freed ones
+            if(claim(entries[index])) {
+                return &entries[index];
+            }
+            index = count.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+/// Publishes filled in entry
+template<typename T>
+void
+publish(T& entry)
+{
+    entry.state.store(METRICS_ENTRY_ACTIVE, std::memory_order_release);
+}
+
+/// Frees entry, so it is no longer shown and can be reused
+template<typename T>
+void
+release(T* entry)
+{
+    if(entry != nullptr) {
+        entry->state.store(METRICS_ENTRY_FREE, std::memory_order_release);
+    }
+}
+} // namespace
+
+MetricsBlock*
+Metrics::block()
+{
+    std::call_once(metrics_initialization_flag, []() { metrics_block = map_block(); });
+    return metrics_block;
+}
+
+QueueMetrics*
+Metrics::register_queue(const char* name, size_t capacity)
+{
+    MetricsBlock* metrics = block();
+    uint32_t index;
+    QueueMetrics* entry = reserve(metrics->queue_count, metrics->queues, index);
+    if(entry != nullptr) {
+        copy_name(entry->name, name, "queue", index);
+        entry->capacity.store(capacity, std::memory_order_relaxed);
+        // the entry may be reused after a destroyed queue
+        entry->depth.store(0, std::memory_order_relaxed);
+        entry->peak_depth.store(0, std::memory_order_relaxed);
+        entry->puts.store(0, std::memory_order_relaxed);
+        entry->gets.store(0, std::memory_order_relaxed);
+        entry->drops.store(0, std::memory_order_relaxed);
+        entry->resizes.store(0, std::memory_order_relaxed);
+        publish(*entry);
+    }
+    return entry;
+}
+
+void
+Metrics::unregister_queue(QueueMetrics* metrics)
+{
+    release(metrics);
+}
+
+ThreadMetrics*
+Metrics::register_thread(const char* name, int priority, size_t stack_size)
+{
+    MetricsBlock* metrics = block();
+    uint32_t index;
+    ThreadMetrics* entry = reserve(metrics->thread_count, metrics->threads, index);
+    if(entry != nullptr) {
+        copy_name(entry->name, name, "thread", index);
+        entry->priority.store(priority, std::memory_order_relaxed);
+        entry->stack_size.store(stack_size, std::memory_order_relaxed);
+        publish(*entry);
+    }
+    return entry;
+}
+
+TimerMetrics*
+Metrics::register_timer(const char* name, uint64_t period_ns)
+{
+    MetricsBlock* metrics = block();
+    uint32_t index;
+    TimerMetrics* entry = reserve(metrics->timer_count, metrics->timers, index);
+    if(entry != nullptr) {
+        copy_name(entry->name, name, "timer", index);
+        entry->period_ns.store(period_ns, std::memory_order_relaxed);
+        publish(*entry);
+    }
+    return entry;
+}
+
+LockMetrics*
+Metrics::register_lock(const char* name)
+{
+    MetricsBlock* metrics = block();
+    uint32_t index;
+    LockMetrics* entry = reserve(metrics->lock_count, metrics->locks, index);
+    if(entry != nullptr) {
+        copy_name(entry->name, name, "lock", index);
+        // the entry may be reused after a destroyed lock
+        entry->acquisitions.store(0, std::memory_order_relaxed);
+        entry->contended_acquisitions.store(0, std::memory_order_relaxed);
+        entry->wait_time_ns.store(0, std::memory_order_relaxed);
+        publish(*entry);
+    }
+    return entry;
+}
+
+void
+Metrics::unregister_lock(LockMetrics* metrics)
+{
+    release(metrics);
+}
+} // namespace taste
@@ -0,0 +1,293 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_METRICS_H
+#define TASTE_METRICS_H
+
+/**
+ * @file    Metrics.h
+ * @brief   Live runtime metrics published in shared memory.
+ *
+ * When RT_ENABLE_METRICS is defined, Queue, Thread, Timer and Lock register
+ * their metrics in a block placed in shared memory segment named
+ * RT_METRICS_SHM_PREFIX followed by the process ID. The metrics are updated
+ * with relaxed atomic operations and can be inspected by external tools,
+ * e.g. taste-top. The layout of the block is identified by METRICS_VERSION.
+ *
+ * Each entry is published by setting its state to METRICS_ENTRY_ACTIVE with
+ * release ordering after it is filled in, so readers shall load the state
+ * with acquire ordering and skip entries which are not active. Entries of
+ * destroyed queues and locks are freed and reused by later registrations.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef RT_METRICS_SHM_PREFIX
+#define RT_METRICS_SHM_PREFIX "/taste-metrics-"
+#endif
+
+#ifndef RT_METRICS_MAX_QUEUES
+#define RT_METRICS_MAX_QUEUES 64
+#endif
+
+#ifndef RT_METRICS_MAX_THREADS
+#define RT_METRICS_MAX_THREADS 128
+#endif
+
+#ifndef RT_METRICS_MAX_TIMERS
+#define RT_METRICS_MAX_TIMERS 64
+#endif
+
+#ifndef RT_METRICS_MAX_LOCKS
+#define RT_METRICS_MAX_LOCKS 128
+#endif
+
+namespace taste {
+/// Identifies the metrics block
+constexpr uint32_t METRICS_MAGIC = 0x54535445U;
+/// Version of the metrics block layout
+constexpr uint32_t METRICS_VERSION = 3;
+/// Maximum length of names in metrics, including terminating zero
+constexpr size_t METRICS_NAME_LENGTH = 32;
+
+/// Counter shared between processes
+using MetricsCounter = std::atomic<uint64_t>;
+
+static_assert(MetricsCounter::is_always_lock_free, "metrics counters shall be address-free");
+
+/// State of entry which is not used
+constexpr uint32_t METRICS_ENTRY_FREE = 0;
+/// State of entry which is being filled in
+constexpr uint32_t METRICS_ENTRY_INITIALIZING = 1;
+/// State of entry which is published
+constexpr uint32_t METRICS_ENTRY_ACTIVE = 2;
+
+/// State of metrics entry shared between processes
+using MetricsEntryState = std::atomic<uint32_t>;
+
+/// Metrics of single queue
+struct QueueMetrics
+{
+    /// State of the entry
+    MetricsEntryState state;
+    /// Name of the queue
+    char name[METRICS_NAME_LENGTH];
+    /// Maximum number of elements, current capacity of queues with adaptive capacity
+    MetricsCounter capacity;
+    /// Current number of elements
+    MetricsCounter depth;
+    /// Maximum observed number of elements
+    MetricsCounter peak_depth;
+    /// Number of inserted elements
+    MetricsCounter puts;
+    /// Number of removed elements
+    MetricsCounter gets;
+    /// Number of dropped elements
+    MetricsCounter drops;
+    /// Number of capacity changes of queues with adaptive capacity
+    MetricsCounter resizes;
+};
+
+/// Metrics of single thread
+struct ThreadMetrics
+{
+    /// State of the entry
+    MetricsEntryState state;
+    /// Name of the thread
+    char name[METRICS_NAME_LENGTH];
+    /// Kernel thread ID, 0 until the thread is started
+    std::atomic<int32_t> thread_id;
+    /// Priority of the thread
+    std::atomic<int32_t> priority;
+    /// Stack size of the thread
+    MetricsCounter stack_size;
+};
+
+/// Metrics of single cyclic interface
+struct TimerMetrics
+{
+    /// State of the entry
+    MetricsEntryState state;
+    /// Name of the interface
+    char name[METRICS_NAME_LENGTH];
+    /// Period of the interface
+    MetricsCounter period_ns;
+    /// Number of activations
+    MetricsCounter activations;
+    /// Number of activations which did not finish before the next activation
+    MetricsCounter overruns;
+    /// Maximum delay of activation
+    MetricsCounter max_lateness_ns;
+};
+
+/// Metrics of single lock
+struct LockMetrics
+{
+    /// State of the entry
+    MetricsEntryState state;
+    /// Name of the lock
+    char name[METRICS_NAME_LENGTH];
+    /// Number of acquisitions
+    MetricsCounter acquisitions;
+    /// Number of acquisitions which had to wait
+    MetricsCounter contended_acquisitions;
+    /// Total time spent waiting for the lock
+    MetricsCounter wait_time_ns;
+};
+
+/// Metrics block placed in shared memory
+struct MetricsBlock
+{
+    /// METRICS_MAGIC
+    uint32_t magic;
+    /// METRICS_VERSION
+    uint32_t version;
+    /// Size of the whole block, used to validate the layout
+    uint64_t size;
+    /// ID of the process
+    int32_t process_id;
+    /// Number of queue entries ever used, including freed ones
+    std::atomic<uint32_t> queue_count;
+    /// Number of thread entries ever used
+    std::atomic<uint32_t> thread_count;
+    /// Number of timer entries ever used
+    std::atomic<uint32_t> timer_count;
+    /// Number of lock entries ever used, including freed ones
+    std::atomic<uint32_t> lock_count;
+    /// Queue metrics
+    QueueMetrics queues[RT_METRICS_MAX_QUEUES];
+    /// Thread metrics
+    ThreadMetrics threads[RT_METRICS_MAX_THREADS];
+    /// Timer metrics
+    TimerMetrics timers[RT_METRICS_MAX_TIMERS];
+    /// Lock metrics
+    LockMetrics locks[RT_METRICS_MAX_LOCKS];
+};
+
+/**
+ * @brief Registry of runtime metrics.
+ *
+ * Register functions return nullptr when the limit of entries is reached,
+ * in which case the entity is not monitored.
+ */
+class Metrics final
+{
+  public:
+    /// @brief deleted default constructor
+    Metrics() = delete;
+
+    /**
+     * @brief Get the metrics block, creating it on first use.
+     *
+     * @return metrics block
+     */
+    static MetricsBlock* block();
+
+    /**
+     * @brief Register queue
+     *
+     * @param name      name of the queue
+     * @param capacity  maximum number of elements
+     *
+     * @return queue metrics or nullptr
+     */
+    static QueueMetrics* register_queue(const char* name, size_t capacity);
+
+    /**
+     * @brief Unregister queue, its entry can be reused
+     *
+     * @param metrics   queue metrics, may be nullptr
+     */
+    static void unregister_queue(QueueMetrics* metrics);
+
+    /**
+     * @brief Register thread
+     *
+     * @param name          name of the thread, may be nullptr
+     * @param priority      priority of the thread
+     * @param stack_size    stack size of the thread
+     *
+     * @return thread metrics or nullptr
+     */
+    static ThreadMetrics* register_thread(const char* name, int priority, size_t stack_size);
+
+    /**
+     * @brief Register cyclic interface
+     *
+     * @param name      name of the interface, may be nullptr
+     * @param period_ns period of the interface
+     *
+     * @return timer metrics or nullptr
+     */
+    static TimerMetrics* register_timer(const char* name, uint64_t period_ns);
+
+    /**
+     * @brief Register lock
+     *
+     * @param name      name of the lock, may be nullptr
+     *
+     * @return lock metrics or nullptr
+     */
+    static LockMetrics* register_lock(const char* name);
+
+    /**
+     * @brief Unregister lock, its entry can be reused
+     *
+     * @param metrics   lock metrics, may be nullptr
+     */
+    static void unregister_lock(LockMetrics* metrics);
+
+    /**
+     * @brief Increment counter updated by single writer at a time.
+     *
+     * @param counter   counter
+     * @param value     increment
+     */
+    static void add(MetricsCounter& counter, uint64_t value = 1);
+
+    /**
+     * @brief Update maximum updated by single writer at a time.
+     *
+     * @param maximum   maximum value
+     * @param value     new sample
+     */
+    static void update_maximum(MetricsCounter& maximum, uint64_t value);
+};
+
+inline void
+Metrics::add(MetricsCounter& counter, uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+inline void
+Metrics::update_maximum(MetricsCounter& maximum, uint64_t value)
+{
+    if(value > maximum.load(std::memory_order_relaxed)) {
+        maximum.store(value, std::memory_order_relaxed);
+    }
+}
+} // namespace taste
+
+#endif
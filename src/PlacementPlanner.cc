@@ -0,0 +1,407 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PlacementPlanner.h"
+
+#include "Sysfs.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <string>
+
+#include <sched.h>
+
+namespace taste {
+namespace {
+constexpr size_t NOT_PLACED = SIZE_MAX;
+const char* const CPU_SYSFS_PATH = "/sys/devices/system/cpu/";
+
+} // namespace
+
+PlacementPlanner::PlacementPlanner(std::vector<CpuInfo> cpus)
+    : m_cpus(std::move(cpus))
+    , m_planned(false)
+{
+    if(m_cpus.empty()) {
+        std::cerr << "Placement planner requires at least one CPU" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+std::vector<CpuInfo>
+PlacementPlanner::read_cpu_topology()
+{
+    std::string online;
+    if(!Sysfs::read_line(std::string(CPU_SYSFS_PATH) + "online", online)) {
+        std::cerr << "Unable to read list of online CPUs" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // threads pinned outside the affinity mask, e.g. set by cpusets or taskset, cannot be created
+    cpu_set_t allowed_cpus;
+    CPU_ZERO(&allowed_cpus);
+    const bool affinity_known = sched_getaffinity(0, sizeof(allowed_cpus), &allowed_cpus) == 0;
+
+    std::vector<CpuInfo> cpus;
+    for(const int cpu : Sysfs::parse_cpu_list(online)) {
+        if(affinity_known && (cpu >= CPU_SETSIZE || !CPU_ISSET(static_cast<size_t>(cpu), &allowed_cpus))) {
+            continue;
+        }
+        const std::string cpu_path = std::string(CPU_SYSFS_PATH) + "cpu" + std::to_string(cpu) + "/";
+        CpuInfo info{ cpu, 0, -1, cpu };
+
+        std::string line;
+        if(Sysfs::read_line(cpu_path + "topology/physical_package_id", line)) {
+            // the package stays 0 if the entry is malformed
+            Sysfs::parse_number(line, info.package);
+        }
+        for(int index = 0;; ++index) {
+            const std::string cache_path = cpu_path + "cache/index" + std::to_string(index) + "/";
+            if(!Sysfs::read_line(cache_path + "level", line)) {
+                break;
+            }
+            int level = 0;
+            std::string shared;
+            if(!Sysfs::parse_number(line, level) || (level != 2 && level != 3)
+               || !Sysfs::read_line(cache_path + "shared_cpu_list", shared)) {
+                continue;
+            }
+            const std::vector<int> shared_cpus = Sysfs::parse_cpu_list(shared);
+            if(shared_cpus.empty()) {
+                continue;
+            }
+            const int group = *std::min_element(shared_cpus.begin(), shared_cpus.end());
+            if(level == 3) {
+                info.l3_group = group;
+            } else {
+                info.l2_group = group;
+            }
+        }
+        cpus.push_back(info);
+    }
+    if(cpus.empty()) {
+        std::cerr << "None of online CPUs '" << online << "' is available to the process" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // without last level cache information the whole package is one cluster
+    for(CpuInfo& info : cpus) {
+        if(info.l3_group < 0) {
+            info.l3_group = info.cpu;
+            for(const CpuInfo& other : cpus) {
+                if(other.package == info.package) {
+                    info.l3_group = std::min(info.l3_group, other.cpu);
+                }
+            }
+        }
+    }
+
+    return cpus;
+}
+
+PlacementPlanner::FunctionId
+PlacementPlanner::add_function(const char* name, double utilization)
+{
+    m_functions.push_back(Function{ name, utilization, NOT_PLACED });
+    m_planned = false;
+    return m_functions.size() - 1;
+}
+
+void
+PlacementPlanner::add_traffic(FunctionId from, FunctionId to, double messages_per_second)
+{
+    if(from >= m_functions.size() || to >= m_functions.size()) {
+        std::cerr << "Traffic between unknown functions " << from << " and " << to << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if(from == to) {
+        return;
+    }
+
+    for(Traffic& traffic : m_traffic) {
+        if((traffic.from == from && traffic.to == to) || (traffic.from == to && traffic.to == from)) {
+            traffic.rate += messages_per_second;
+            m_planned = false;
+            return;
+        }
+    }
+    m_traffic.push_back(Traffic{ from, to, messages_per_second });
+    m_planned = false;
+}
+
+void
+PlacementPlanner::plan()
+{
+    std::vector<Cluster> cluster_list = clusters();
+    double max_cluster_capacity = 0.0;
+    for(const Cluster& cluster : cluster_list) {
+        max_cluster_capacity = std::max(max_cluster_capacity, cluster.capacity);
+    }
+
+    std::vector<std::vector<FunctionId>> groups = group_functions(max_cluster_capacity);
+    std::vector<double> group_utilizations;
+    for(const std::vector<FunctionId>& group : groups) {
+        double utilization = 0.0;
+        for(const FunctionId function : group) {
+            utilization += m_functions[function].utilization;
+        }
+        group_utilizations.push_back(utilization);
+    }
+    std::vector<size_t> group_order(groups.size());
+    std::iota(group_order.begin(), group_order.end(), 0);
+    std::stable_sort(group_order.begin(), group_order.end(), [&group_utilizations](size_t lhs, size_t rhs) {
+        return group_utilizations[lhs] > group_utilizations[rhs];
+    });
+
+    // groups are assigned to clusters, heaviest first
+    std::vector<int> function_packages(m_functions.size(), -1);
+    std::vector<std::vector<FunctionId>> cluster_functions(cluster_list.size());
+    for(const size_t group_index : group_order) {
+        const std::vector<FunctionId>& group = groups[group_index];
+        const size_t cluster =
+                select_cluster(group, group_utilizations[group_index], cluster_list, function_packages);
+        cluster_list[cluster].load += group_utilizations[group_index];
+        for(const FunctionId function : group) {
+            function_packages[function] = cluster_list[cluster].package;
+            cluster_functions[cluster].push_back(function);
+        }
+    }
+
+    // functions are assigned to CPUs of their cluster, heaviest first
+    for(Function& function : m_functions) {
+        function.cpu_index = NOT_PLACED;
+    }
+    std::vector<double> cpu_loads(m_cpus.size(), 0.0);
+    for(size_t cluster = 0; cluster < cluster_list.size(); ++cluster) {
+        std::vector<FunctionId>& functions = cluster_functions[cluster];
+        std::stable_sort(functions.begin(), functions.end(), [this](FunctionId lhs, FunctionId rhs) {
+            return m_functions[lhs].utilization > m_functions[rhs].utilization;
+        });
+        for(const FunctionId function : functions) {
+            const size_t cpu_index = select_cpu(function, cluster_list[cluster], cpu_loads);
+            m_functions[function].cpu_index = cpu_index;
+            cpu_loads[cpu_index] += m_functions[function].utilization;
+        }
+    }
+
+    m_planned = true;
+}
+
+int
+PlacementPlanner::cpu_of(FunctionId function) const
+{
+    if(!m_planned || function >= m_functions.size()) {
+        std::cerr << "Placement of function " << function << " is not planned" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return m_cpus[m_functions[function].cpu_index].cpu;
+}
+
+void
+PlacementPlanner::apply(FunctionId function, Thread& thread) const
+{
+    thread.set_cpu(cpu_of(function));
+}
+
+void
+PlacementPlanner::print_plan(std::ostream& stream) const
+{
+    if(!m_planned) {
+        stream << "Placement is not planned" << std::endl;
+        return;
+    }
+
+    stream << "Placement plan:" << std::endl;
+    std::vector<double> cpu_loads(m_cpus.size(), 0.0);
+    for(const Function& function : m_functions) {
+        const CpuInfo& cpu = m_cpus[function.cpu_index];
+        stream << "  " << function.name << ": cpu " << cpu.cpu << " (package " << cpu.package << ", L3 group "
+               << cpu.l3_group << "), utilization " << function.utilization << std::endl;
+        cpu_loads[function.cpu_index] += function.utilization;
+    }
+
+    stream << "CPU utilization:" << std::endl;
+    for(size_t i = 0; i < m_cpus.size(); ++i) {
+        stream << "  cpu " << m_cpus[i].cpu << ": " << cpu_loads[i] << std::endl;
+    }
+
+    double total = 0.0;
+    double cross_l3 = 0.0;
+    double cross_package = 0.0;
+    for(const Traffic& traffic : m_traffic) {
+        const CpuInfo& from = m_cpus[m_functions[traffic.from].cpu_index];
+        const CpuInfo& to = m_cpus[m_functions[traffic.to].cpu_index];
+        total += traffic.rate;
+        if(from.l3_group != to.l3_group) {
+            cross_l3 += traffic.rate;
+        }
+        if(from.package != to.package) {
+            cross_package += traffic.rate;
+        }
+    }
+    stream << "Traffic: " << total << " messages/s, crossing L3 groups " << cross_l3 << ", crossing packages "
+           << cross_package << std::endl;
+}
+
+std::vector<PlacementPlanner::Cluster>
+PlacementPlanner::clusters() const
+{
+    std::vector<Cluster> result;
+    for(size_t i = 0; i < m_cpus.size(); ++i) {
+        auto cluster = std::find_if(result.begin(), result.end(), [this, i](const Cluster& c) {
+            return c.l3_group == m_cpus[i].l3_group;
+        });
+        if(cluster == result.end()) {
+            result.push_back(Cluster{ m_cpus[i].l3_group, m_cpus[i].package, 0.0, 0.0, {} });
+            cluster = result.end() - 1;
+        }
+        cluster->capacity += RT_PLACEMENT_CPU_CAPACITY;
+        cluster->cpu_indices.push_back(i);
+    }
+    return result;
+}
+
+std::vector<std::vector<PlacementPlanner::FunctionId>>
+PlacementPlanner::group_functions(double max_group_utilization) const
+{
+    // union-find, merging along the heaviest traffic first
+    std::vector<FunctionId> parent(m_functions.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    std::vector<double> utilizations;
+    for(const Function& function : m_functions) {
+        utilizations.push_back(function.utilization);
+    }
+    const auto find_root = [&parent](FunctionId function) {
+        while(parent[function] != function) {
+            parent[function] = parent[parent[function]];
+            function = parent[function];
+        }
+        return function;
+    };
+
+    std::vector<Traffic> traffic = m_traffic;
+    std::stable_sort(traffic.begin(), traffic.end(), [](const Traffic& lhs, const Traffic& rhs) {
+        return lhs.rate > rhs.rate;
+    });
+    for(const Traffic& edge : traffic) {
+        const FunctionId from = find_root(edge.from);
+        const FunctionId to = find_root(edge.to);
+        if(from != to && utilizations[from] + utilizations[to] <= max_group_utilization) {
+            parent[to] = from;
+            utilizations[from] += utilizations[to];
+        }
+    }
+
+    std::vector<std::vector<FunctionId>> groups;
+    std::vector<size_t> group_of_root(m_functions.size(), NOT_PLACED);
+    for(FunctionId function = 0; function < m_functions.size(); ++function) {
+        const FunctionId root = find_root(function);
+        if(group_of_root[root] == NOT_PLACED) {
+            group_of_root[root] = groups.size();
+            groups.emplace_back();
+        }
+        groups[group_of_root[root]].push_back(function);
+    }
+    return groups;
+}
+
+size_t
+PlacementPlanner::select_cluster(const std::vector<FunctionId>& group,
+                                 double group_utilization,
+                                 const std::vector<Cluster>& cluster_list,
+                                 const std::vector<int>& function_packages) const
+{
+    size_t best = NOT_PLACED;
+    double best_affinity = -1.0;
+    double best_remaining = 0.0;
+    for(size_t cluster = 0; cluster < cluster_list.size(); ++cluster) {
+        const double remaining = cluster_list[cluster].capacity - cluster_list[cluster].load;
+        if(remaining < group_utilization) {
+            continue;
+        }
+        // traffic to functions already placed in the package of the cluster
+        double affinity = 0.0;
+        for(const FunctionId function : group) {
+            for(FunctionId other = 0; other < m_functions.size(); ++other) {
+                if(function_packages[other] == cluster_list[cluster].package) {
+                    affinity += traffic_between(function, other);
+                }
+            }
+        }
+        if(affinity > best_affinity || (affinity == best_affinity && remaining > best_remaining)) {
+            best = cluster;
+            best_affinity = affinity;
+            best_remaining = remaining;
+        }
+    }
+    if(best != NOT_PLACED) {
+        return best;
+    }
+
+    // the system is overloaded, the least loaded cluster is used
+    best = 0;
+    for(size_t cluster = 1; cluster < cluster_list.size(); ++cluster) {
+        if(cluster_list[cluster].capacity - cluster_list[cluster].load
+           > cluster_list[best].capacity - cluster_list[best].load) {
+            best = cluster;
+        }
+    }
+    return best;
+}
+
+size_t
+PlacementPlanner::select_cpu(FunctionId function, const Cluster& cluster, const std::vector<double>& cpu_loads) const
+{
+    size_t best = cluster.cpu_indices.front();
+    double best_affinity = -1.0;
+    for(const size_t cpu_index : cluster.cpu_indices) {
+        // traffic to functions already placed in the same L2 group
+        double affinity = 0.0;
+        for(FunctionId other = 0; other < m_functions.size(); ++other) {
+            const size_t other_cpu = m_functions[other].cpu_index;
+            if(other_cpu != NOT_PLACED && m_cpus[other_cpu].l2_group == m_cpus[cpu_index].l2_group) {
+                affinity += traffic_between(function, other);
+            }
+        }
+        if(cpu_loads[cpu_index] < cpu_loads[best]
+           || (cpu_loads[cpu_index] == cpu_loads[best] && affinity > best_affinity)) {
+            best = cpu_index;
+            best_affinity = affinity;
+        }
+    }
+    return best;
+}
+
+double
+PlacementPlanner::traffic_between(FunctionId first, FunctionId second) const
+{
+    for(const Traffic& traffic : m_traffic) {
+        if((traffic.from == first && traffic.to == second) || (traffic.from == second && traffic.to == first)) {
+            return traffic.rate;
+        }
+    }
+    return 0.0;
+}
+} // namespace taste
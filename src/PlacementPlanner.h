@@ -0,0 +1,195 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_PLACEMENT_PLANNER_H
+#define TASTE_PLACEMENT_PLANNER_H
+
+/**
+ * @file    PlacementPlanner.h
+ * @brief   Traffic-aware assignment of function threads to CPUs.
+ */
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+#include "Thread.h"
+
+#ifndef RT_PLACEMENT_CPU_CAPACITY
+#define RT_PLACEMENT_CPU_CAPACITY 0.8
+#endif
+
+namespace taste {
+/**
+ * @brief Location of a CPU in the cache and package hierarchy
+ *
+ * Groups are identified by the lowest CPU index in the group.
+ */
+struct CpuInfo
+{
+    /// Index of the CPU
+    int cpu;
+    /// Physical package (socket) of the CPU
+    int package;
+    /// Group of CPUs sharing the last level cache
+    int l3_group;
+    /// Group of CPUs sharing the L2 cache
+    int l2_group;
+};
+
+/**
+ * @brief Planner of thread placement based on CPU topology and traffic.
+ *
+ * Functions are described by their CPU utilization, and traffic by message
+ * rates between functions, e.g. measured using Metrics. The planner:
+ *  - merges functions along the heaviest traffic edges into groups,
+ *    as long as a group fits into one last level cache cluster,
+ *  - assigns groups, heaviest first, to clusters in the package which
+ *    already hosts most of their traffic, otherwise to the least loaded cluster,
+ *  - assigns functions in a cluster to the least loaded CPU, preferring
+ *    CPUs sharing L2 cache with communicating functions.
+ *
+ * A CPU is considered full at RT_PLACEMENT_CPU_CAPACITY utilization.
+ * The plan is applied by pinning threads using Thread::set_cpu,
+ * before the threads are started.
+ */
+class PlacementPlanner final
+{
+  public:
+    /**
+     * @brief Type definition of function identifier
+     */
+    using FunctionId = size_t;
+
+    /**
+     * @brief Constructor
+     *
+     * @param cpus      CPUs available for function threads
+     */
+    explicit PlacementPlanner(std::vector<CpuInfo> cpus);
+
+    /**
+     * @brief Read topology of online CPUs from sysfs
+     *
+     * Only CPUs in the affinity mask of the calling thread are returned,
+     * so CPUs excluded by cpusets or taskset are not planned. If cache
+     * information is not available, all CPUs of a package are assumed
+     * to share the last level cache. Malformed sysfs entries are ignored.
+     *
+     * @return topology of online CPUs available to the process
+     */
+    static std::vector<CpuInfo> read_cpu_topology();
+
+    /**
+     * @brief Add function to the plan
+     *
+     * @param name          name of the function
+     * @param utilization   CPU utilization of the function, 1.0 is one CPU
+     *
+     * @return identifier of the function
+     */
+    FunctionId add_function(const char* name, double utilization);
+
+    /**
+     * @brief Add traffic between functions
+     *
+     * Traffic is symmetric, rates between the same functions are accumulated.
+     *
+     * @param from                  sender function
+     * @param to                    receiver function
+     * @param messages_per_second   message rate
+     */
+    void add_traffic(FunctionId from, FunctionId to, double messages_per_second);
+
+    /**
+     * @brief Compute the placement
+     */
+    void plan();
+
+    /**
+     * @brief Get CPU assigned to the function
+     *
+     * @param function      identifier of the function
+     *
+     * @return index of the CPU
+     */
+    int cpu_of(FunctionId function) const;
+
+    /**
+     * @brief Pin thread of the function to the assigned CPU
+     *
+     * This shall be used before the thread is started.
+     *
+     * @param function      identifier of the function
+     * @param thread        thread of the function
+     */
+    void apply(FunctionId function, Thread& thread) const;
+
+    /**
+     * @brief Print the plan with CPU loads and traffic crossing clusters
+     *
+     * @param stream    output stream
+     */
+    void print_plan(std::ostream& stream) const;
+
+  private:
+    struct Function
+    {
+        const char* name;
+        double utilization;
+        size_t cpu_index;
+    };
+
+    struct Traffic
+    {
+        FunctionId from;
+        FunctionId to;
+        double rate;
+    };
+
+    struct Cluster
+    {
+        int l3_group;
+        int package;
+        double capacity;
+        double load;
+        std::vector<size_t> cpu_indices;
+    };
+
+    std::vector<Cluster> clusters() const;
+    std::vector<std::vector<FunctionId>> group_functions(double max_group_utilization) const;
+    size_t select_cluster(const std::vector<FunctionId>& group,
+                          double group_utilization,
+                          const std::vector<Cluster>& clusters,
+                          const std::vector<int>& function_packages) const;
+    size_t select_cpu(FunctionId function, const Cluster& cluster, const std::vector<double>& cpu_loads) const;
+    double traffic_between(FunctionId first, FunctionId second) const;
+
+  private:
+    std::vector<CpuInfo> m_cpus;
+    std::vector<Function> m_functions;
+    std::vector<Traffic> m_traffic;
+    bool m_planned;
+};
+} // namespace taste
+
+#endif
@@ -28,17 +28,18 @@
  * @brief   Message queue implementation for TASTE.
  */
 
-#include <condition_variable>
-#include <iostream>
-#include <mutex>
-#include <queue>
-
+#include "QueueCore.h"
 #include "Request.h"
 
 namespace taste {
 /**
  * @brief    Message queue implmentation.
  *
+ * Thin typed wrapper of QueueCore, which implements the queue independently
+ * of the request size, so queues of different sizes share the same code.
+ * See QueueCore for per-sender fairness, adaptive capacity, direct handoff
+ * and single-threaded behaviour.
+ *
  * @tparam PARAMETER_SIZE The maximum size of single request in bytes.
  */
 template<size_t PARAMETER_SIZE>
@@ -48,6 +49,10 @@ class Queue final
     /**
      * @brief Constructor
      *
+     * Storage for all elements is allocated here, so put and get
+     * do not allocate memory. The storage is backed by huge pages
+     * if RT_USE_HUGE_PAGES is defined.
+     *
      * @param max_elements    Maximum number of elements
      * @param queue_name      Name of the queue used for error messages
      */
@@ -65,30 +70,105 @@ class Queue final
     /// @brief deleted move assignment operator
     Queue& operator=(Queue&&) = delete;
 
+    /**
+     * @brief Enable per-sender fairness
+     *
+     * This shall be used before the queue is used.
+     *
+     * @param default_quota   Maximum number of requests of a single sender in queue
+     */
+    void enable_sender_fairness(size_t default_quota);
+
+    /**
+     * @brief Set the quota of sender
+     *
+     * Requires per-sender fairness to be enabled.
+     *
+     * @param sender_pid  The pid of the sender function
+     * @param quota       Maximum number of requests of the sender in queue
+     */
+    void set_sender_quota(asn1SccPID sender_pid, size_t quota);
+
+    /**
+     * @brief Set the weight of sender
+     *
+     * Requires per-sender fairness to be enabled.
+     *
+     * @param sender_pid  The pid of the sender function
+     * @param weight      Number of requests dequeued in the turn of the sender, at least 1
+     */
+    void set_sender_weight(asn1SccPID sender_pid, size_t weight);
+
+    /**
+     * @brief Enable adaptive capacity
+     *
+     * This shall be used before the queue is used. It cannot be combined
+     * with per-sender fairness.
+     *
+     * @param segment_elements  Number of elements in one segment
+     */
+    void enable_adaptive_capacity(size_t segment_elements);
+
+    /**
+     * @brief Get the current capacity
+     *
+     * @return number of elements which fit in memory backed storage
+     */
+    size_t capacity() const;
+
+    /**
+     * @brief Get the peak depth
+     *
+     * @return maximum observed number of elements
+     */
+    size_t peak_depth() const;
+
+    /**
+     * @brief Get the number of capacity changes
+     *
+     * @return number of segments which were faulted in or released
+     */
+    uint64_t resize_count() const;
+
+    /**
+     * @brief Enable or disable direct handoff to a waiting consumer
+     *
+     * Direct handoff is enabled by default.
+     *
+     * @param enabled  true if requests shall be handed off directly
+     */
+    void set_direct_handoff(bool enabled);
+
     /**
      * @brief Put message into queue
      *
      * If queue is full the request will be dropped.
+     * If per-sender fairness is enabled and the sender exceeds its quota,
+     * the request will be dropped.
      * After successfull operation, the waiting thread will be notified.
      *
      * @param request  The request which will be inserted into queue
+     *
+     * @return true if the request was stored, false if it was dropped
      */
-    void put(const Request<PARAMETER_SIZE>& request);
+    bool put(const Request<PARAMETER_SIZE>& request);
 
     /**
      * @brief Put raw data into queue
      *
-     * This function creates appropriate Request with given data before
-     * putting it into queue.
      * If queue is full the request will be dropped.
-     * If length is larger than PARAMETER_SIZE the request will be dropped.
+     * If per-sender fairness is enabled and the sender exceeds its quota,
+     * the request will be dropped.
+     * If length is larger than PARAMETER_SIZE the program is terminated.
      * After successfull operation, the waiting thread will be notified.
      *
      * @param sender_pid  The pid of the sender function
      * @param data        The buffer with the request data
      * @param length      The length of the request
+     *
+     * @return true if the request was stored, false if it was dropped
      */
-    void put(const asn1SccPID sender_pid, const uint8_t* data, size_t length);
+    bool put(const asn1SccPID sender_pid, const uint8_t* data, size_t length);
 
     /**
      * @brief Get request from queue.
@@ -99,6 +179,15 @@ class Queue final
      */
     void get(Request<PARAMETER_SIZE>& request);
 
+    /**
+     * @brief Get request from queue without waiting.
+     *
+     * @param request  The request reveived from queue, if available
+     *
+     * @return true if request was received, false if queue is empty
+     */
+    bool try_get(Request<PARAMETER_SIZE>& request);
+
     /**
      * @brief Checks if queue is empty.
      *
@@ -107,96 +196,116 @@ class Queue final
     bool is_empty() const;
 
   private:
-    bool check_for_message_loss() const;
-
-  private:
-    const size_t m_max_elements;
-    const char* m_queue_name;
-    mutable std::mutex m_mutex;
-    mutable std::condition_variable m_condition_variable;
-    std::queue<Request<PARAMETER_SIZE>> m_queue;
+    QueueCore m_core;
 };
 
 template<size_t PARAMETER_SIZE>
 Queue<PARAMETER_SIZE>::Queue(const size_t max_elements, const char* queue_name)
-    : m_max_elements(max_elements)
-    , m_queue_name(queue_name)
+    : m_core(max_elements, PARAMETER_SIZE, queue_name)
 {
 }
 
 template<size_t PARAMETER_SIZE>
-void
-Queue<PARAMETER_SIZE>::put(const Request<PARAMETER_SIZE>& request)
+inline void
+Queue<PARAMETER_SIZE>::enable_sender_fairness(size_t default_quota)
 {
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
+    m_core.enable_sender_fairness(default_quota);
+}
 
-        if(check_for_message_loss()) {
-            return;
-        }
+template<size_t PARAMETER_SIZE>
+inline void
+Queue<PARAMETER_SIZE>::set_sender_quota(asn1SccPID sender_pid, size_t quota)
+{
+    m_core.set_sender_quota(static_cast<int>(sender_pid), quota);
+}
 
-        m_queue.push(request);
-    }
+template<size_t PARAMETER_SIZE>
+inline void
+Queue<PARAMETER_SIZE>::set_sender_weight(asn1SccPID sender_pid, size_t weight)
+{
+    m_core.set_sender_weight(static_cast<int>(sender_pid), weight);
+}
 
-    m_condition_variable.notify_one();
+template<size_t PARAMETER_SIZE>
+inline void
+Queue<PARAMETER_SIZE>::enable_adaptive_capacity(size_t segment_elements)
+{
+    m_core.enable_adaptive_capacity(segment_elements);
 }
 
 template<size_t PARAMETER_SIZE>
-void
-Queue<PARAMETER_SIZE>::put(const asn1SccPID sender_pid, const uint8_t* data, size_t length)
+inline size_t
+Queue<PARAMETER_SIZE>::capacity() const
 {
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
+    return m_core.capacity();
+}
 
-        if(check_for_message_loss()) {
-            return;
-        }
+template<size_t PARAMETER_SIZE>
+inline size_t
+Queue<PARAMETER_SIZE>::peak_depth() const
+{
+    return m_core.peak_depth();
+}
 
-        m_queue.emplace(sender_pid, data, length);
-    }
+template<size_t PARAMETER_SIZE>
+inline uint64_t
+Queue<PARAMETER_SIZE>::resize_count() const
+{
+    return m_core.resize_count();
+}
 
-    m_condition_variable.notify_one();
+template<size_t PARAMETER_SIZE>
+inline void
+Queue<PARAMETER_SIZE>::set_direct_handoff(bool enabled)
+{
+    m_core.set_direct_handoff(enabled);
 }
 
 template<size_t PARAMETER_SIZE>
-void
-Queue<PARAMETER_SIZE>::get(Request<PARAMETER_SIZE>& request)
+inline bool
+Queue<PARAMETER_SIZE>::put(const Request<PARAMETER_SIZE>& request)
 {
-    std::unique_lock<std::mutex> lock(m_mutex);
-
-    while(true) {
-        if(m_queue.empty()) {
-            m_condition_variable.wait(lock);
-        } else {
-            request = m_queue.front();
-            m_queue.pop();
-            return;
-        }
-    }
+    return m_core.put(static_cast<int>(request.sender_pid()), request.data(), request.length());
 }
 
 template<size_t PARAMETER_SIZE>
-bool
-Queue<PARAMETER_SIZE>::is_empty() const
+inline bool
+Queue<PARAMETER_SIZE>::put(const asn1SccPID sender_pid, const uint8_t* data, size_t length)
 {
-    std::unique_lock<std::mutex> lock(m_mutex);
-    return m_queue.empty();
+    return m_core.put(static_cast<int>(sender_pid), data, length);
 }
 
 template<size_t PARAMETER_SIZE>
-bool
-Queue<PARAMETER_SIZE>::check_for_message_loss() const
+inline void
+Queue<PARAMETER_SIZE>::get(Request<PARAMETER_SIZE>& request)
 {
-    if(m_queue.size() >= m_max_elements) {
-        std::cerr << "Message loss in '" << m_queue_name << "' - queue is full, " << m_max_elements
-                  << " elements are allowed" << std::endl;
+    int sender_pid;
+    size_t length;
+    m_core.get(sender_pid, request.data(), length);
+    request.set_sender_pid(static_cast<asn1SccPID>(sender_pid));
+    request.set_length(length);
+}
 
-        return true;
+template<size_t PARAMETER_SIZE>
+inline bool
+Queue<PARAMETER_SIZE>::try_get(Request<PARAMETER_SIZE>& request)
+{
+    int sender_pid;
+    size_t length;
+    if(!m_core.try_get(sender_pid, request.data(), length)) {
+        return false;
     }
-
-    return false;
+    request.set_sender_pid(static_cast<asn1SccPID>(sender_pid));
+    request.set_length(length);
+    return true;
 }
 
+template<size_t PARAMETER_SIZE>
+inline bool
+Queue<PARAMETER_SIZE>::is_empty() const
+{
+    return m_core.is_empty();
+}
 } // namespace taste
 
 #endif
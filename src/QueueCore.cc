@@ -0,0 +1,754 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "QueueCore.h"
+
+#include "Clock.h"
+#include "HugePageAllocator.h"
+#include "MemoryReport.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace taste {
+namespace {
+/// Slots are aligned, so the slot header can be accessed in place
+constexpr size_t SLOT_ALIGNMENT = alignof(std::max_align_t);
+
+/// Marks that no segment shall be faulted in or released
+constexpr size_t NO_SEGMENT = static_cast<size_t>(-1);
+
+uint8_t*
+allocate_storage(size_t size)
+{
+    if(HugePageAllocator::is_enabled()) {
+        return static_cast<uint8_t*>(HugePageAllocator::allocate(size, SLOT_ALIGNMENT));
+    }
+    // new[] of bytes is aligned for any fundamental type
+    return new uint8_t[size];
+}
+
+void
+deallocate_storage(uint8_t* storage, size_t size)
+{
+    if(HugePageAllocator::is_enabled()) {
+        HugePageAllocator::deallocate(storage, size);
+    } else {
+        delete[] storage;
+    }
+}
+
+/// Segmented storage is mapped, so its pages are backed by memory only when accessed
+uint8_t*
+allocate_segments(size_t size)
+{
+    if(HugePageAllocator::is_enabled()) {
+        return allocate_storage(size);
+    }
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if(memory == MAP_FAILED) {
+        std::cerr << "Unable to map queue storage of " << size << " bytes" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return static_cast<uint8_t*>(memory);
+}
+
+void
+deallocate_segments(uint8_t* storage, size_t size)
+{
+    if(HugePageAllocator::is_enabled()) {
+        deallocate_storage(storage, size);
+    } else {
+        munmap(storage, size);
+    }
+}
+
+/// Returns the whole pages within the given range, size is 0 if there is no such page
+uint8_t*
+whole_pages(uint8_t* begin, size_t& size)
+{
+    const uintptr_t page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t first = (reinterpret_cast<uintptr_t>(begin) + page_size - 1) / page_size * page_size;
+    const uintptr_t last = (reinterpret_cast<uintptr_t>(begin) + size) / page_size * page_size;
+    size = last > first ? last - first : 0;
+    return reinterpret_cast<uint8_t*>(first);
+}
+} // namespace
+
+QueueCore::QueueCore(const size_t max_elements, const size_t parameter_size, const char* queue_name)
+    : m_max_elements(max_elements)
+    , m_parameter_size(parameter_size)
+    , m_stride(slot_stride(parameter_size))
+    , m_queue_name(queue_name)
+    , m_buffer(allocate_storage(max_elements * m_stride))
+    , m_buffer_elements(max_elements)
+    , m_head(0)
+    , m_size(0)
+    , m_peak_size(0)
+    , m_free_slot(0)
+    , m_current_sender(0)
+    , m_direct_handoff(true)
+    , m_handoff_waiter(nullptr)
+#ifdef RT_ENABLE_METRICS
+    , m_metrics(Metrics::register_queue(queue_name, max_elements))
+#endif
+{
+    MemoryReport::add(MemoryReport::Category::QueueStorage, max_elements * m_stride);
+}
+
+QueueCore::~QueueCore()
+{
+#ifdef RT_ENABLE_METRICS
+    Metrics::unregister_queue(m_metrics);
+#endif
+    MemoryReport::remove(MemoryReport::Category::QueueStorage, resident_bytes());
+    if(m_adaptive != nullptr) {
+        deallocate_segments(m_buffer, m_buffer_elements * m_stride);
+    } else {
+        deallocate_storage(m_buffer, m_buffer_elements * m_stride);
+    }
+}
+
+void
+QueueCore::enable_sender_fairness(size_t default_quota)
+{
+    std::lock_guard<RuntimeMutex> lock(m_mutex);
+
+    if(m_size != 0) {
+        std::cerr << "Sender fairness of '" << m_queue_name << "' shall be enabled before the queue is used"
+                  << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if(m_adaptive != nullptr) {
+        std::cerr << "Sender fairness of '" << m_queue_name << "' cannot be combined with adaptive capacity"
+                  << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    m_senders.reset(new SenderState[RT_QUEUE_MAX_SENDERS]);
+    for(size_t i = 0; i < RT_QUEUE_MAX_SENDERS; ++i) {
+        m_senders[i] = SenderState{ 0, 0, 0, default_quota, 1, 1 };
+    }
+
+    // all slots form the list of free slots
+    m_next_slot.reset(new size_t[m_max_elements]);
+    for(size_t i = 0; i < m_max_elements; ++i) {
+        m_next_slot[i] = i + 1;
+    }
+    m_free_slot = 0;
+    m_current_sender = 0;
+}
+
+void
+QueueCore::set_sender_quota(int sender_pid, size_t quota)
+{
+    std::lock_guard<RuntimeMutex> lock(m_mutex);
+    sender_state(sender_pid).quota = quota;
+}
+
+void
+QueueCore::set_sender_weight(int sender_pid, size_t weight)
+{
+    std::lock_guard<RuntimeMutex> lock(m_mutex);
+
+    if(weight == 0) {
+        std::cerr << "Weight of sender in '" << m_queue_name << "' shall be at least 1" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    SenderState& sender = sender_state(sender_pid);
+    sender.weight = weight;
+    sender.credit = weight;
+}
+
+void
+QueueCore::enable_adaptive_capacity(size_t segment_elements)
+{
+    std::lock_guard<RuntimeMutex> lock(m_mutex);
+
+    if(m_size != 0) {
+        std::cerr << "Adaptive capacity of '" << m_queue_name << "' shall be enabled before the queue is used"
+                  << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if(m_senders != nullptr || m_adaptive != nullptr) {
+        std::cerr << "Adaptive capacity of '" << m_queue_name
+                  << "' cannot be combined with sender fairness or enabled twice" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if(segment_elements == 0) {
+        std::cerr << "Segment of '" << m_queue_name << "' shall hold at least 1 element" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    MemoryReport::remove(MemoryReport::Category::QueueStorage, resident_bytes());
+    deallocate_storage(m_buffer, m_buffer_elements * m_stride);
+
+    // requests span one segment more than their count requires, when the head is not at a segment boundary,
+    // and up to two segments are outside the lists while they are faulted in or released
+    const size_t elements = std::min(segment_elements, m_max_elements);
+    const size_t segment_count = (m_max_elements + elements - 1) / elements + 3;
+    m_adaptive.reset(new AdaptiveState{ elements,
+                                        segment_count,
+                                        1,
+                                        std::unique_ptr<size_t[]>(new size_t[segment_count]),
+                                        std::unique_ptr<size_t[]>(new size_t[segment_count]),
+                                        0,
+                                        std::unique_ptr<size_t[]>(new size_t[segment_count]),
+                                        0,
+                                        0,
+                                        0,
+                                        0,
+                                        0,
+                                        false,
+                                        false,
+                                        false,
+                                        0,
+                                        0 });
+    m_buffer_elements = segment_count * elements;
+    m_buffer = allocate_segments(m_buffer_elements * m_stride);
+
+    // the first segment is used from the start, the others are faulted in on demand
+    AdaptiveState& state = *m_adaptive;
+    memset(m_buffer, 0, elements * m_stride);
+    for(size_t segment = segment_count - 1; segment > 0; --segment) {
+        if(HugePageAllocator::is_enabled()) {
+            // huge pages are reserved anyway, so all segments are resident
+            state.resident_free[state.resident_free_count++] = segment;
+            ++state.resident_segments;
+        } else {
+            state.released_free[state.released_free_count++] = segment;
+        }
+    }
+
+    MemoryReport::add(MemoryReport::Category::QueueStorage, resident_bytes());
+#ifdef RT_ENABLE_METRICS
+    if(m_metrics != nullptr) {
+        m_metrics->capacity.store(std::min(state.resident_segments * elements, m_max_elements),
+                                  std::memory_order_relaxed);
+    }
+#endif
+}
+
+size_t
+QueueCore::capacity() const
+{
+    std::lock_guard<RuntimeMutex> lock(m_mutex);
+    if(m_adaptive == nullptr) {
+        return m_max_elements;
+    }
+    return std::min(m_adaptive->resident_segments * m_adaptive->segment_elements, m_max_elements);
+}
+
+size_t
+QueueCore::peak_depth() const
+{
+    std::lock_guard<RuntimeMutex> lock(m_mutex);
+    return m_peak_size;
+}
+
+uint64_t
+QueueCore::resize_count() const
+{
+    std::lock_guard<RuntimeMutex> lock(m_mutex);
+    return m_adaptive != nullptr ? m_adaptive->resize_count : 0;
+}
+
+void
+QueueCore::set_direct_handoff(bool enabled)
+{
+    std::lock_guard<RuntimeMutex> lock(m_mutex);
+    m_direct_handoff = enabled;
+}
+
+bool
+QueueCore::put(const int sender_pid, const uint8_t* data, size_t length)
+{
+    if(length > m_parameter_size) {
+        std::cerr << "Request data size shall be <= " << m_parameter_size << " - new length value (" << length
+                  << ") is greater than " << m_parameter_size << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    size_t resized_segment = NO_SEGMENT;
+    bool grow = false;
+    bool handed_off = false;
+    {
+        std::lock_guard<RuntimeMutex> lock(m_mutex);
+
+        if(check_for_message_loss(sender_pid)) {
+            return false;
+        }
+
+        if(m_handoff_waiter != nullptr) {
+            hand_off(sender_pid, data, length);
+            handed_off = true;
+        } else {
+            uint8_t* const slot = push_slot(sender_pid);
+            SlotHeader* const header = reinterpret_cast<SlotHeader*>(slot);
+            header->length = length;
+            header->sender_pid = sender_pid;
+            memcpy(slot + sizeof(SlotHeader), data, length);
+            record_depth_change(true);
+        }
+
+        if(m_adaptive != nullptr) {
+            resized_segment = plan_resize(grow);
+        }
+    }
+
+    // the consumer is notified after unlocking, so it does not block on the mutex after waking up
+    if(handed_off) {
+        // another consumer may already wait for the next handoff, so all are woken to check their requests
+        m_handoff_condition_variable.notify_all();
+    } else {
+        m_condition_variable.notify_one();
+    }
+
+    // the consumer is already notified, so it does not wait for the page faults or the system call
+    if(resized_segment != NO_SEGMENT) {
+        finish_resize(resized_segment, grow);
+    }
+    return true;
+}
+
+void
+QueueCore::get(int& sender_pid, uint8_t* data, size_t& length)
+{
+    std::unique_lock<RuntimeMutex> lock(m_mutex);
+
+    if(m_size == 0 && m_direct_handoff && m_handoff_waiter == nullptr) {
+        wait_for_handoff(lock, sender_pid, data, length);
+        return;
+    }
+
+    while(true) {
+        if(m_size == 0) {
+            wait_while_idle(lock, m_condition_variable);
+        } else {
+            pop(sender_pid, data, length);
+            return;
+        }
+    }
+}
+
+bool
+QueueCore::try_get(int& sender_pid, uint8_t* data, size_t& length)
+{
+    std::unique_lock<RuntimeMutex> lock(m_mutex);
+
+    if(m_size == 0) {
+        // the consumer has nothing to process, so it may give back a segment
+        release_idle_segment(lock);
+        return false;
+    }
+
+    pop(sender_pid, data, length);
+    return true;
+}
+
+bool
+QueueCore::is_empty() const
+{
+    std::unique_lock<RuntimeMutex> lock(m_mutex);
+    return m_size == 0;
+}
+
+size_t
+QueueCore::slot_stride(size_t parameter_size)
+{
+    const size_t slot_size = sizeof(SlotHeader) + parameter_size;
+    return (slot_size + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT * SLOT_ALIGNMENT;
+}
+
+bool
+QueueCore::check_for_message_loss(int sender_pid) const
+{
+    const bool queue_full = m_size >= m_max_elements || !segment_available();
+    const bool quota_exceeded =
+            m_senders != nullptr && sender_state(sender_pid).count >= sender_state(sender_pid).quota;
+    if(queue_full || quota_exceeded) {
+#ifdef RT_ENABLE_METRICS
+        if(m_metrics != nullptr) {
+            Metrics::add(m_metrics->drops);
+        }
+#endif
+        if(queue_full) {
+            std::cerr << "Message loss in '" << m_queue_name << "' - queue is full, " << m_max_elements
+                      << " elements are allowed" << std::endl;
+        } else {
+            std::cerr << "Message loss in '" << m_queue_name << "' - sender " << sender_pid << " exceeded its quota, "
+                      << sender_state(sender_pid).quota << " elements are allowed" << std::endl;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+uint8_t*
+QueueCore::push_slot(int sender_pid)
+{
+    ++m_size;
+
+    if(m_adaptive != nullptr) {
+        return m_buffer + push_segment_slot() * m_stride;
+    }
+
+    if(m_senders == nullptr) {
+        size_t tail = m_head + m_size - 1;
+        if(tail >= m_max_elements) {
+            tail -= m_max_elements;
+        }
+        return m_buffer + tail * m_stride;
+    }
+
+    // the slot is moved from the list of free slots to the FIFO of sender
+    const size_t slot = m_free_slot;
+    m_free_slot = m_next_slot[slot];
+    SenderState& sender = sender_state(sender_pid);
+    if(sender.count == 0) {
+        sender.head = slot;
+    } else {
+        m_next_slot[sender.tail] = slot;
+    }
+    sender.tail = slot;
+    ++sender.count;
+
+    return m_buffer + slot * m_stride;
+}
+
+void
+QueueCore::pop(int& sender_pid, uint8_t* data, size_t& length)
+{
+    size_t slot;
+    if(m_adaptive != nullptr) {
+        slot = pop_segment_slot();
+    } else if(m_senders == nullptr) {
+        slot = m_head;
+        m_head = m_head + 1 == m_max_elements ? 0 : m_head + 1;
+    } else {
+        slot = pop_fair_slot();
+        m_next_slot[slot] = m_free_slot;
+        m_free_slot = slot;
+    }
+
+    const uint8_t* const slot_data = m_buffer + slot * m_stride;
+    const SlotHeader* const header = reinterpret_cast<const SlotHeader*>(slot_data);
+    sender_pid = header->sender_pid;
+    length = header->length;
+    memcpy(data, slot_data + sizeof(SlotHeader), length);
+
+    --m_size;
+    record_depth_change(false);
+}
+
+void
+QueueCore::wait_for_handoff(std::unique_lock<RuntimeMutex>& lock,
+                            int& sender_pid,
+                            uint8_t* data,
+                            size_t& length)
+{
+    // while the waiter is registered, all requests are handed off, so the queue stays empty
+    HandoffWaiter waiter;
+    waiter.data = data;
+    waiter.filled = false;
+    m_handoff_waiter = &waiter;
+
+    while(!waiter.filled) {
+        wait_while_idle(lock, m_handoff_condition_variable);
+    }
+
+    sender_pid = waiter.sender_pid;
+    length = waiter.length;
+}
+
+void
+QueueCore::hand_off(int sender_pid, const uint8_t* data, size_t length)
+{
+    HandoffWaiter& waiter = *m_handoff_waiter;
+    m_handoff_waiter = nullptr;
+
+    memcpy(waiter.data, data, length);
+    waiter.sender_pid = sender_pid;
+    waiter.length = length;
+    waiter.filled = true;
+    record_depth_change(true);
+    record_depth_change(false);
+}
+
+size_t
+QueueCore::pop_fair_slot()
+{
+    // the queue is not empty, so the loop ends at a sender with requests
+    while(true) {
+        SenderState& sender = m_senders[m_current_sender];
+        if(sender.count != 0 && sender.credit != 0) {
+            const size_t slot = sender.head;
+            sender.head = m_next_slot[slot];
+            --sender.count;
+            --sender.credit;
+            return slot;
+        }
+        // the credit is restored for the next turn of the sender
+        sender.credit = sender.weight;
+        m_current_sender = m_current_sender + 1 == RT_QUEUE_MAX_SENDERS ? 0 : m_current_sender + 1;
+    }
+}
+
+bool
+QueueCore::segment_available() const
+{
+    // segments are sized for the worst case, this only guards against indexing empty lists
+    if(m_adaptive == nullptr || m_adaptive->tail_offset != m_adaptive->segment_elements) {
+        return true;
+    }
+    return m_adaptive->resident_free_count != 0 || m_adaptive->released_free_count != 0;
+}
+
+size_t
+QueueCore::push_segment_slot()
+{
+    AdaptiveState& state = *m_adaptive;
+    if(state.tail_offset == state.segment_elements) {
+        size_t segment;
+        if(state.resident_free_count != 0) {
+            segment = state.resident_free[--state.resident_free_count];
+        } else {
+            // the growth was not fast enough, so the segment is faulted in by this put
+            segment = state.released_free[--state.released_free_count];
+            ++state.resident_segments;
+            record_resize(true);
+        }
+        state.next_segment[state.tail_segment] = segment;
+        state.tail_segment = segment;
+        state.tail_offset = 0;
+    }
+    return state.tail_segment * state.segment_elements + state.tail_offset++;
+}
+
+size_t
+QueueCore::pop_segment_slot()
+{
+    AdaptiveState& state = *m_adaptive;
+    const size_t slot = state.head_segment * state.segment_elements + state.head_offset++;
+    if(m_size == 1) {
+        // the queue becomes empty, so the current segment is reused from its beginning
+        state.head_offset = 0;
+        state.tail_offset = 0;
+    } else if(state.head_offset == state.segment_elements) {
+        // the slot is read before the mutex is unlocked, so the segment is not released before
+        const size_t segment = state.head_segment;
+        state.head_segment = state.next_segment[segment];
+        state.head_offset = 0;
+        state.resident_free[state.resident_free_count++] = segment;
+    }
+    return slot;
+}
+
+size_t
+QueueCore::plan_resize(bool& grow)
+{
+    AdaptiveState& state = *m_adaptive;
+    const size_t capacity = state.resident_segments * state.segment_elements;
+
+    if(m_size * 100 >= capacity * RT_QUEUE_GROW_THRESHOLD_PERCENT) {
+        state.low_occupancy = false;
+        if(state.growing || state.released_free_count == 0) {
+            return NO_SEGMENT;
+        }
+        state.growing = true;
+        grow = true;
+        return state.released_free[--state.released_free_count];
+    }
+
+    grow = false;
+    return plan_shrink();
+}
+
+size_t
+QueueCore::plan_shrink()
+{
+    AdaptiveState& state = *m_adaptive;
+    const size_t capacity = state.resident_segments * state.segment_elements;
+
+    if(m_size * 100 > capacity * RT_QUEUE_SHRINK_THRESHOLD_PERCENT || HugePageAllocator::is_enabled()) {
+        state.low_occupancy = false;
+        return NO_SEGMENT;
+    }
+
+    const uint64_t now = Clock::now_ns();
+    if(!state.low_occupancy) {
+        state.low_occupancy = true;
+        state.low_occupancy_since_ns = now;
+        return NO_SEGMENT;
+    }
+
+    const uint64_t delay_ns = static_cast<uint64_t>(RT_QUEUE_SHRINK_DELAY_MS) * 1000000;
+    if(now - state.low_occupancy_since_ns < delay_ns || state.shrinking || state.resident_free_count == 0
+       || state.resident_segments == 1) {
+        return NO_SEGMENT;
+    }
+
+    // the next segment is released after another period of low occupancy
+    state.low_occupancy_since_ns = now;
+    state.shrinking = true;
+    --state.resident_segments;
+    record_resize(false);
+    return state.resident_free[--state.resident_free_count];
+}
+
+bool
+QueueCore::release_idle_segment(std::unique_lock<RuntimeMutex>& lock)
+{
+    if(m_adaptive == nullptr) {
+        return false;
+    }
+
+    const size_t segment = plan_shrink();
+    if(segment == NO_SEGMENT) {
+        return false;
+    }
+    lock.unlock();
+    finish_resize(segment, false);
+    lock.lock();
+    return true;
+}
+
+void
+QueueCore::wait_while_idle(std::unique_lock<RuntimeMutex>& lock, RuntimeConditionVariable& condition_variable)
+{
+    if(m_adaptive == nullptr || HugePageAllocator::is_enabled()) {
+        condition_variable.wait(lock);
+        return;
+    }
+
+    if(release_idle_segment(lock)) {
+        // the mutex was unlocked meanwhile, so the caller checks its condition again
+        return;
+    }
+    if(m_adaptive->resident_segments == 1 && !m_adaptive->growing) {
+        condition_variable.wait(lock);
+    } else {
+        // the consumer wakes up to release the next segment, if the queue stays idle
+        condition_variable.wait_for(lock, std::chrono::milliseconds(RT_QUEUE_SHRINK_DELAY_MS));
+    }
+}
+
+void
+QueueCore::finish_resize(size_t segment, bool grow)
+{
+    AdaptiveState& state = *m_adaptive;
+    const size_t segment_size = state.segment_elements * m_stride;
+    uint8_t* const segment_begin = m_buffer + segment * segment_size;
+
+    // the segment is in none of the lists, so it is accessed without the mutex
+    if(grow) {
+        memset(segment_begin, 0, segment_size);
+    } else {
+        // pages shared with neighbouring segments are kept
+        size_t size = segment_size;
+        uint8_t* const pages = whole_pages(segment_begin, size);
+        if(size != 0) {
+            madvise(pages, size, MADV_DONTNEED);
+        }
+    }
+
+    std::lock_guard<RuntimeMutex> lock(m_mutex);
+    if(grow) {
+        state.resident_free[state.resident_free_count++] = segment;
+        state.growing = false;
+        ++state.resident_segments;
+        record_resize(true);
+    } else {
+        state.released_free[state.released_free_count++] = segment;
+        state.shrinking = false;
+    }
+}
+
+void
+QueueCore::record_resize(bool grow)
+{
+    const size_t segment_size = m_adaptive->segment_elements * m_stride;
+    ++m_adaptive->resize_count;
+    if(grow) {
+        MemoryReport::add(MemoryReport::Category::QueueStorage, segment_size);
+    } else {
+        MemoryReport::remove(MemoryReport::Category::QueueStorage, segment_size);
+    }
+#ifdef RT_ENABLE_METRICS
+    if(m_metrics != nullptr) {
+        Metrics::add(m_metrics->resizes);
+        m_metrics->capacity.store(std::min(m_adaptive->resident_segments * m_adaptive->segment_elements,
+                                           m_max_elements),
+                                  std::memory_order_relaxed);
+    }
+#endif
+}
+
+size_t
+QueueCore::resident_bytes() const
+{
+    if(m_adaptive == nullptr) {
+        return m_buffer_elements * m_stride;
+    }
+    return m_adaptive->resident_segments * m_adaptive->segment_elements * m_stride;
+}
+
+QueueCore::SenderState&
+QueueCore::sender_state(int sender_pid) const
+{
+    if(m_senders == nullptr) {
+        std::cerr << "Sender fairness of '" << m_queue_name << "' is not enabled" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return m_senders[static_cast<size_t>(sender_pid) % RT_QUEUE_MAX_SENDERS];
+}
+
+void
+QueueCore::record_depth_change(bool put)
+{
+    // called with the mutex locked, so there is single writer
+    m_peak_size = std::max(m_peak_size, m_size);
+#ifdef RT_ENABLE_METRICS
+    if(m_metrics != nullptr) {
+        Metrics::add(put ? m_metrics->puts : m_metrics->gets);
+        m_metrics->depth.store(m_size, std::memory_order_relaxed);
+        Metrics::update_maximum(m_metrics->peak_depth, m_size);
+    }
+#else
+    (void)put;
+#endif
+}
+} // namespace taste
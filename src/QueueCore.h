@@ -0,0 +1,361 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_QUEUE_CORE_H
+#define TASTE_QUEUE_CORE_H
+
+/**
+ * @file    QueueCore.h
+ * @brief   Size-independent implementation of message queue.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "SingleThreaded.h"
+
+#ifdef RT_ENABLE_METRICS
+#include "Metrics.h"
+#endif
+
+#ifndef RT_QUEUE_MAX_SENDERS
+#define RT_QUEUE_MAX_SENDERS 64
+#endif
+
+/// Depth, in percent of the current capacity, above which adaptive queue prepares the next segment
+#ifndef RT_QUEUE_GROW_THRESHOLD_PERCENT
+#define RT_QUEUE_GROW_THRESHOLD_PERCENT 75
+#endif
+
+/// Depth, in percent of the current capacity, below which adaptive queue is considered underused
+#ifndef RT_QUEUE_SHRINK_THRESHOLD_PERCENT
+#define RT_QUEUE_SHRINK_THRESHOLD_PERCENT 25
+#endif
+
+/// Time of low occupancy after which adaptive queue releases one unused segment
+#ifndef RT_QUEUE_SHRINK_DELAY_MS
+#define RT_QUEUE_SHRINK_DELAY_MS 1000
+#endif
+
+namespace taste {
+/**
+ * @brief    Message queue operating on byte slots.
+ *
+ * The core does not depend on the maximum size of request, which is
+ * given at runtime, so a single copy of locking, waiting and FIFO code
+ * serves queues of all sizes. Each slot holds the sender PID, the length
+ * and the data of one request, slots are placed at a fixed stride in
+ * a preallocated buffer. Only the used part of the data is copied.
+ * Sender PIDs are stored as plain integers, so the core does not depend
+ * on the generated dataview, Queue converts them to asn1SccPID.
+ *
+ * By default, the queue is a single FIFO. Optionally, per-sender fairness
+ * can be enabled, then requests of each sender are kept in a separate FIFO,
+ * the number of requests of a single sender is limited by its quota, and
+ * requests are dequeued round-robin across senders. A sender with weight n
+ * gets up to n consecutive requests dequeued in its turn. Senders are
+ * distinguished modulo RT_QUEUE_MAX_SENDERS.
+ *
+ * Optionally, the capacity can be adaptive. Then requests are kept in a
+ * chain of fixed-size segments of the buffer, and only the memory of
+ * resident segments is backed by physical pages. The queue starts with one
+ * resident segment. When the depth crosses RT_QUEUE_GROW_THRESHOLD_PERCENT
+ * of the current capacity, the producer faults in the next segment after
+ * releasing the lock, so neither the consumer nor other producers wait for
+ * it. When the depth stays below RT_QUEUE_SHRINK_THRESHOLD_PERCENT for
+ * RT_QUEUE_SHRINK_DELAY_MS, one unused segment is given back to the system,
+ * and another one after each further RT_QUEUE_SHRINK_DELAY_MS. This is done
+ * by a producer after it notified the consumer, or by a consumer which has
+ * nothing to process: while it waits in get or when try_get finds the queue
+ * empty. So segments are released also when the queue is idle or all
+ * requests are handed off, and never while a request waits for the consumer.
+ * The total number of requests is still limited by max_elements.
+ *
+ * When a consumer waits in get on an empty queue, put hands the request
+ * off directly: the data is copied into the buffer of the consumer, which
+ * is woken on a separate condition variable, so the request does not pass
+ * through a slot and no consumer waiting for a slot is woken. Only one consumer
+ * waits for the handoff, the others wait for requests put into slots.
+ *
+ * When RT_SINGLE_THREADED is defined, the queue does not synchronize,
+ * and get on an empty queue terminates the program.
+ */
+class QueueCore final
+{
+  public:
+    /**
+     * @brief Constructor
+     *
+     * Storage for all elements is allocated here, so put and get
+     * do not allocate memory. The storage is backed by huge pages
+     * if RT_USE_HUGE_PAGES is defined.
+     *
+     * @param max_elements    Maximum number of elements
+     * @param parameter_size  Maximum size of single request in bytes
+     * @param queue_name      Name of the queue used for error messages
+     */
+    QueueCore(const size_t max_elements, const size_t parameter_size, const char* queue_name);
+
+    /// @brief Destructor
+    ~QueueCore();
+
+    /// @brief deleted copy constructor
+    QueueCore(const QueueCore&) = delete;
+
+    /// @brief deleted move constructor
+    QueueCore(QueueCore&&) = delete;
+
+    /// @brief deleted copy assignment operator
+    QueueCore& operator=(const QueueCore&) = delete;
+
+    /// @brief deleted move assignment operator
+    QueueCore& operator=(QueueCore&&) = delete;
+
+    /**
+     * @brief Enable per-sender fairness
+     *
+     * This shall be used before the queue is used.
+     *
+     * @param default_quota   Maximum number of requests of a single sender in queue
+     */
+    void enable_sender_fairness(size_t default_quota);
+
+    /**
+     * @brief Set the quota of sender
+     *
+     * Requires per-sender fairness to be enabled.
+     *
+     * @param sender_pid  The pid of the sender function
+     * @param quota       Maximum number of requests of the sender in queue
+     */
+    void set_sender_quota(int sender_pid, size_t quota);
+
+    /**
+     * @brief Set the weight of sender
+     *
+     * Requires per-sender fairness to be enabled.
+     *
+     * @param sender_pid  The pid of the sender function
+     * @param weight      Number of requests dequeued in the turn of the sender, at least 1
+     */
+    void set_sender_weight(int sender_pid, size_t weight);
+
+    /**
+     * @brief Enable adaptive capacity
+     *
+     * This shall be used before the queue is used. It cannot be combined
+     * with per-sender fairness. Memory of segments is released only if the
+     * storage is not backed by huge pages, and only in whole pages, so the
+     * segment should span at least a few pages.
+     *
+     * @param segment_elements  Number of elements in one segment
+     */
+    void enable_adaptive_capacity(size_t segment_elements);
+
+    /**
+     * @brief Get the current capacity
+     *
+     * @return number of elements in resident segments, or max_elements
+     *         if adaptive capacity is disabled
+     */
+    size_t capacity() const;
+
+    /**
+     * @brief Get the peak depth
+     *
+     * @return maximum observed number of elements
+     */
+    size_t peak_depth() const;
+
+    /**
+     * @brief Get the number of capacity changes
+     *
+     * @return number of segments which were faulted in or released
+     */
+    uint64_t resize_count() const;
+
+    /**
+     * @brief Enable or disable direct handoff to a waiting consumer
+     *
+     * Direct handoff is enabled by default. A consumer already waiting
+     * for the handoff still receives the next request directly.
+     *
+     * @param enabled  true if requests shall be handed off directly
+     */
+    void set_direct_handoff(bool enabled);
+
+    /**
+     * @brief Put request into queue
+     *
+     * If queue is full the request will be dropped.
+     * If per-sender fairness is enabled and the sender exceeds its quota,
+     * the request will be dropped.
+     * The length shall not be larger than the maximum size of request.
+     * After successfull operation, the waiting thread will be notified,
+     * or the request will be handed off directly to the waiting consumer.
+     *
+     * @param sender_pid  The pid of the sender function
+     * @param data        The buffer with the request data
+     * @param length      The length of the request
+     *
+     * @return true if the request was stored or handed off, false if it was dropped
+     */
+    bool put(const int sender_pid, const uint8_t* data, size_t length);
+
+    /**
+     * @brief Get request from queue.
+     *
+     * If queue is empty, the function waits for a request.
+     *
+     * @param sender_pid  The pid of the sender of the received request
+     * @param data        The buffer for the request data, of the maximum size of request
+     * @param length      The length of the received request
+     */
+    void get(int& sender_pid, uint8_t* data, size_t& length);
+
+    /**
+     * @brief Get request from queue without waiting.
+     *
+     * @param sender_pid  The pid of the sender of the received request
+     * @param data        The buffer for the request data, of the maximum size of request
+     * @param length      The length of the received request
+     *
+     * @return true if request was received, false if queue is empty
+     */
+    bool try_get(int& sender_pid, uint8_t* data, size_t& length);
+
+    /**
+     * @brief Checks if queue is empty.
+     *
+     * @return true is queue is empty, otherwise false
+     */
+    bool is_empty() const;
+
+  private:
+    struct SlotHeader
+    {
+        size_t length;
+        int sender_pid;
+    };
+
+    /// State of adaptive capacity, segments are identified by their index in the buffer
+    struct AdaptiveState
+    {
+        size_t segment_elements;
+        size_t segment_count;
+        size_t resident_segments;
+        /// Next segment in the chain of segments holding requests
+        std::unique_ptr<size_t[]> next_segment;
+        /// Unused segments backed by memory
+        std::unique_ptr<size_t[]> resident_free;
+        size_t resident_free_count;
+        /// Unused segments given back to the system
+        std::unique_ptr<size_t[]> released_free;
+        size_t released_free_count;
+        size_t head_segment;
+        size_t head_offset;
+        size_t tail_segment;
+        size_t tail_offset;
+        /// A segment is faulted in or released outside the mutex, so it is in none of the lists
+        bool growing;
+        bool shrinking;
+        bool low_occupancy;
+        uint64_t low_occupancy_since_ns;
+        uint64_t resize_count;
+    };
+
+    /// Consumer waiting for direct handoff, placed on the stack of the consumer
+    struct HandoffWaiter
+    {
+        uint8_t* data;
+        int sender_pid;
+        size_t length;
+        bool filled;
+    };
+
+    struct SenderState
+    {
+        size_t head;
+        size_t tail;
+        size_t count;
+        size_t quota;
+        size_t weight;
+        size_t credit;
+    };
+
+    static size_t slot_stride(size_t parameter_size);
+    bool check_for_message_loss(int sender_pid) const;
+    uint8_t* push_slot(int sender_pid);
+    void pop(int& sender_pid, uint8_t* data, size_t& length);
+    void wait_for_handoff(std::unique_lock<RuntimeMutex>& lock,
+                          int& sender_pid,
+                          uint8_t* data,
+                          size_t& length);
+    void hand_off(int sender_pid, const uint8_t* data, size_t length);
+    size_t pop_fair_slot();
+    bool segment_available() const;
+    size_t push_segment_slot();
+    size_t pop_segment_slot();
+    size_t plan_resize(bool& grow);
+    size_t plan_shrink();
+    bool release_idle_segment(std::unique_lock<RuntimeMutex>& lock);
+    void wait_while_idle(std::unique_lock<RuntimeMutex>& lock, RuntimeConditionVariable& condition_variable);
+    void finish_resize(size_t segment, bool grow);
+    void record_resize(bool grow);
+    size_t resident_bytes() const;
+    SenderState& sender_state(int sender_pid) const;
+    void record_depth_change(bool put);
+
+  private:
+    const size_t m_max_elements;
+    const size_t m_parameter_size;
+    const size_t m_stride;
+    const char* m_queue_name;
+    mutable RuntimeMutex m_mutex;
+    mutable RuntimeConditionVariable m_condition_variable;
+    /// Used only by the consumer waiting for direct handoff
+    RuntimeConditionVariable m_handoff_condition_variable;
+    uint8_t* m_buffer;
+    size_t m_buffer_elements;
+    size_t m_head;
+    size_t m_size;
+    size_t m_peak_size;
+    /// Per-sender state, nullptr if fairness is disabled
+    std::unique_ptr<SenderState[]> m_senders;
+    /// Next slot in the FIFO of sender or in the list of free slots
+    std::unique_ptr<size_t[]> m_next_slot;
+    size_t m_free_slot;
+    size_t m_current_sender;
+    /// Adaptive capacity state, nullptr if adaptive capacity is disabled
+    std::unique_ptr<AdaptiveState> m_adaptive;
+    bool m_direct_handoff;
+    /// Consumer waiting for direct handoff, nullptr if there is none
+    HandoffWaiter* m_handoff_waiter;
+#ifdef RT_ENABLE_METRICS
+    QueueMetrics* const m_metrics;
+#endif
+};
+} // namespace taste
+
+#endif
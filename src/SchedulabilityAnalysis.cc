@@ -0,0 +1,363 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SchedulabilityAnalysis.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+
+namespace taste {
+namespace {
+constexpr double NANOSECONDS_IN_MICROSECOND = 1000.0;
+
+double
+to_microseconds(uint64_t nanoseconds)
+{
+    return static_cast<double>(nanoseconds) / NANOSECONDS_IN_MICROSECOND;
+}
+} // namespace
+
+SchedulabilityAnalysis::SchedulabilityAnalysis()
+    : m_analyzed(false)
+    , m_priorities_suggested(false)
+{
+}
+
+SchedulabilityAnalysis::InterfaceId
+SchedulabilityAnalysis::add_cyclic(const char* name,
+                                   int priority,
+                                   uint64_t period_ns,
+                                   uint64_t wcet_ns,
+                                   uint64_t deadline_ns,
+                                   int cpu)
+{
+    return add_interface(name, true, priority, period_ns, wcet_ns, deadline_ns, cpu);
+}
+
+SchedulabilityAnalysis::InterfaceId
+SchedulabilityAnalysis::add_sporadic(const char* name,
+                                     int priority,
+                                     uint64_t minimum_interarrival_ns,
+                                     uint64_t wcet_ns,
+                                     uint64_t deadline_ns,
+                                     int cpu)
+{
+    return add_interface(name, false, priority, minimum_interarrival_ns, wcet_ns, deadline_ns, cpu);
+}
+
+void
+SchedulabilityAnalysis::set_blocking(InterfaceId interface, uint64_t blocking_ns)
+{
+    check_interface(interface);
+    m_interfaces[interface].blocking_ns = blocking_ns;
+    m_analyzed = false;
+    m_priorities_suggested = false;
+}
+
+void
+SchedulabilityAnalysis::use_measured_wcet(InterfaceId interface, const ExecutionStatistics::Summary& statistics)
+{
+    check_interface(interface);
+    Interface& entry = m_interfaces[interface];
+    entry.wcet_ns = std::max(entry.wcet_ns, statistics.max_cpu_time_ns);
+    m_analyzed = false;
+    m_priorities_suggested = false;
+}
+
+bool
+SchedulabilityAnalysis::analyze()
+{
+    std::vector<int> priorities;
+    for(const Interface& interface : m_interfaces) {
+        priorities.push_back(interface.priority);
+    }
+
+    std::vector<uint64_t> response_times;
+    const bool schedulable = compute_response_times(priorities, response_times);
+    for(size_t i = 0; i < m_interfaces.size(); ++i) {
+        m_interfaces[i].response_time_ns = response_times[i];
+    }
+    m_analyzed = true;
+    return schedulable;
+}
+
+bool
+SchedulabilityAnalysis::suggest_priorities(int highest_priority, int lowest_priority)
+{
+    std::vector<size_t> order(m_interfaces.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](size_t lhs, size_t rhs) {
+        return m_interfaces[lhs].deadline_ns < m_interfaces[rhs].deadline_ns;
+    });
+
+    std::vector<int> priorities(m_interfaces.size(), lowest_priority);
+    int priority = highest_priority;
+    for(size_t i = 0; i < order.size(); ++i) {
+        if(i > 0 && m_interfaces[order[i]].deadline_ns != m_interfaces[order[i - 1]].deadline_ns
+           && priority > lowest_priority) {
+            --priority;
+        }
+        priorities[order[i]] = priority;
+    }
+
+    std::vector<uint64_t> response_times;
+    const bool schedulable = compute_response_times(priorities, response_times);
+    for(size_t i = 0; i < m_interfaces.size(); ++i) {
+        m_interfaces[i].suggested_priority = priorities[i];
+        m_interfaces[i].suggested_response_time_ns = response_times[i];
+    }
+    m_priorities_suggested = true;
+    return schedulable;
+}
+
+uint64_t
+SchedulabilityAnalysis::response_time(InterfaceId interface) const
+{
+    if(!m_analyzed) {
+        std::cerr << "Response times are not analyzed" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    check_interface(interface);
+    return m_interfaces[interface].response_time_ns;
+}
+
+int
+SchedulabilityAnalysis::suggested_priority(InterfaceId interface) const
+{
+    if(!m_priorities_suggested) {
+        std::cerr << "Priorities are not suggested" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    check_interface(interface);
+    return m_interfaces[interface].suggested_priority;
+}
+
+double
+SchedulabilityAnalysis::utilization(int cpu) const
+{
+    double result = 0.0;
+    for(const Interface& interface : m_interfaces) {
+        if(interface.cpu == cpu) {
+            result += static_cast<double>(interface.wcet_ns) / static_cast<double>(interface.period_ns);
+        }
+    }
+    return result;
+}
+
+void
+SchedulabilityAnalysis::print_report(std::ostream& stream) const
+{
+    if(!m_analyzed) {
+        stream << "Schedulability is not analyzed" << std::endl;
+        return;
+    }
+
+    stream << "Worst-case response times [us]:" << std::endl;
+    for(const Interface& interface : m_interfaces) {
+        stream << "  " << interface.name << " (" << (interface.cyclic ? "cyclic" : "sporadic") << ", priority "
+               << interface.priority << ", cpu ";
+        if(interface.cpu == ANY_CPU) {
+            stream << "any";
+        } else {
+            stream << interface.cpu;
+        }
+        stream << "): period " << to_microseconds(interface.period_ns) << ", wcet "
+               << to_microseconds(interface.wcet_ns) << ", deadline " << to_microseconds(interface.deadline_ns)
+               << ", response time ";
+        print_response_time(stream, interface, interface.response_time_ns);
+    }
+
+    stream << "CPU utilization:" << std::endl;
+    for(const int cpu : cpus()) {
+        const double cpu_utilization = utilization(cpu);
+        stream << "  cpu ";
+        if(cpu == ANY_CPU) {
+            stream << "any";
+        } else {
+            stream << cpu;
+        }
+        stream << ": " << cpu_utilization << (cpu_utilization > 1.0 ? " OVERLOADED" : "") << std::endl;
+    }
+
+    if(m_priorities_suggested) {
+        stream << "Suggested deadline-monotonic priorities:" << std::endl;
+        for(const Interface& interface : m_interfaces) {
+            stream << "  " << interface.name << ": " << interface.priority << " -> " << interface.suggested_priority
+                   << ", response time ";
+            print_response_time(stream, interface, interface.suggested_response_time_ns);
+        }
+    }
+}
+
+bool
+SchedulabilityAnalysis::verify(int highest_priority, int lowest_priority)
+{
+#ifdef RT_SCHEDULABILITY_ENFORCE
+    for(const Interface& interface : m_interfaces) {
+        if(interface.cpu == ANY_CPU) {
+            std::cerr << "Interface '" << interface.name
+                      << "' is not pinned to a CPU, its response time cannot be verified" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+#endif
+    const bool schedulable = analyze();
+    if(schedulable) {
+        return true;
+    }
+
+    const bool schedulable_with_suggested_priorities = suggest_priorities(highest_priority, lowest_priority);
+    std::cerr << "Configuration is not schedulable";
+    if(schedulable_with_suggested_priorities) {
+        std::cerr << ", but it is schedulable with suggested priorities";
+    }
+    std::cerr << std::endl;
+    print_report(std::cerr);
+#ifdef RT_SCHEDULABILITY_ENFORCE
+    exit(EXIT_FAILURE);
+#else
+    return false;
+#endif
+}
+
+SchedulabilityAnalysis::InterfaceId
+SchedulabilityAnalysis::add_interface(const char* name,
+                                      bool cyclic,
+                                      int priority,
+                                      uint64_t period_ns,
+                                      uint64_t wcet_ns,
+                                      uint64_t deadline_ns,
+                                      int cpu)
+{
+    if(period_ns == 0) {
+        std::cerr << "Period of interface '" << name << "' shall be greater than zero" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if(deadline_ns > period_ns) {
+        std::cerr << "Deadline of interface '" << name << "' shall not be longer than its period" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    Interface interface;
+    interface.name = name;
+    interface.cyclic = cyclic;
+    interface.priority = priority;
+    interface.period_ns = period_ns;
+    interface.wcet_ns = wcet_ns;
+    interface.deadline_ns = deadline_ns != 0 ? deadline_ns : period_ns;
+    interface.blocking_ns = 0;
+    interface.cpu = cpu;
+    interface.response_time_ns = 0;
+    interface.suggested_priority = priority;
+    interface.suggested_response_time_ns = 0;
+    m_interfaces.push_back(interface);
+    m_analyzed = false;
+    m_priorities_suggested = false;
+    return m_interfaces.size() - 1;
+}
+
+void
+SchedulabilityAnalysis::check_interface(InterfaceId interface) const
+{
+    if(interface >= m_interfaces.size()) {
+        std::cerr << "Unknown interface " << interface << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+bool
+SchedulabilityAnalysis::may_interfere(const Interface& other, const Interface& analyzed)
+{
+    // unpinned interfaces may share a CPU with any interface
+    return other.cpu == analyzed.cpu || other.cpu == ANY_CPU || analyzed.cpu == ANY_CPU;
+}
+
+uint64_t
+SchedulabilityAnalysis::compute_response_time(InterfaceId interface, const std::vector<int>& priorities) const
+{
+    const Interface& analyzed = m_interfaces[interface];
+
+    // fixed point iteration, response time grows monotonically, so it stops
+    // at the first value which is stable or exceeds the deadline; it starts
+    // from at least 1 ns, so interfaces with zero execution time still wait
+    // for interfering interfaces released at the same instant
+    uint64_t response_time = std::max<uint64_t>(analyzed.wcet_ns + analyzed.blocking_ns, 1);
+    while(response_time <= analyzed.deadline_ns) {
+        uint64_t next_response_time = analyzed.wcet_ns + analyzed.blocking_ns;
+        for(size_t i = 0; i < m_interfaces.size(); ++i) {
+            const Interface& other = m_interfaces[i];
+            if(i == interface || !may_interfere(other, analyzed) || priorities[i] < priorities[interface]) {
+                continue;
+            }
+            const uint64_t releases = (response_time + other.period_ns - 1) / other.period_ns;
+            next_response_time += releases * other.wcet_ns;
+        }
+        if(next_response_time == response_time) {
+            break;
+        }
+        response_time = next_response_time;
+    }
+    return response_time;
+}
+
+bool
+SchedulabilityAnalysis::compute_response_times(const std::vector<int>& priorities,
+                                               std::vector<uint64_t>& response_times) const
+{
+    bool schedulable = true;
+    response_times.clear();
+    for(size_t i = 0; i < m_interfaces.size(); ++i) {
+        response_times.push_back(compute_response_time(i, priorities));
+        if(response_times.back() > m_interfaces[i].deadline_ns) {
+            schedulable = false;
+        }
+    }
+    return schedulable;
+}
+
+void
+SchedulabilityAnalysis::print_response_time(std::ostream& stream, const Interface& interface, uint64_t response_time_ns)
+{
+    if(response_time_ns > interface.deadline_ns) {
+        stream << "> " << to_microseconds(interface.deadline_ns) << " DEADLINE MISS";
+    } else {
+        stream << to_microseconds(response_time_ns);
+    }
+    stream << (interface.cpu == ANY_CPU ? " (approximate, not pinned)" : "") << std::endl;
+}
+
+std::vector<int>
+SchedulabilityAnalysis::cpus() const
+{
+    std::vector<int> result;
+    for(const Interface& interface : m_interfaces) {
+        if(std::find(result.begin(), result.end(), interface.cpu) == result.end()) {
+            result.push_back(interface.cpu);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+} // namespace taste
@@ -0,0 +1,252 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_SCHEDULABILITY_ANALYSIS_H
+#define TASTE_SCHEDULABILITY_ANALYSIS_H
+
+/**
+ * @file    SchedulabilityAnalysis.h
+ * @brief   Response-time analysis of cyclic and sporadic interfaces.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "ExecutionStatistics.h"
+
+namespace taste {
+/**
+ * @brief Fixed-priority response-time analysis.
+ *
+ * Each cyclic or sporadic interface is described by its thread priority,
+ * period (minimum inter-arrival time for sporadic interfaces), relative
+ * deadline, worst-case execution time and CPU. The analysis computes
+ * worst-case response time of each interface using the classic recurrence
+ *
+ *    R = C + B + sum over interfering interfaces j with not lower priority of ceil(R / T_j) * C_j
+ *
+ * where B is the blocking time, e.g. the longest critical section of
+ * lower priority interfaces sharing a lock. Interfaces of equal priority
+ * interfere with each other, as SCHED_FIFO does not bound the order of
+ * their release. An interface not pinned to any CPU may run on every CPU,
+ * so it interferes with interfaces on all CPUs, and it is itself analysed
+ * as if all interfaces shared one CPU. The recurrence is not a bound for
+ * global scheduling on multiprocessors, so response times of unpinned
+ * interfaces are reported as approximate, and verify rejects them if
+ * RT_SCHEDULABILITY_ENFORCE is defined. Interfaces with zero execution time
+ * still wait for interfering interfaces released at the same instant.
+ *
+ * The recurrence assumes that each job finishes before the next release,
+ * therefore deadlines shall not be longer than periods.
+ *
+ * The analysis can also suggest deadline-monotonic priorities, which are
+ * rate-monotonic for interfaces with deadlines equal to periods.
+ * This is optimal ordering for fixed-priority scheduling on one CPU.
+ *
+ * Priorities follow Thread, higher value is higher priority.
+ */
+class SchedulabilityAnalysis final
+{
+  public:
+    /**
+     * @brief Type definition of interface identifier
+     */
+    using InterfaceId = size_t;
+
+    /// CPU of interfaces not pinned to any CPU
+    static constexpr int ANY_CPU = -1;
+
+    /**
+     * @brief Constructor
+     */
+    SchedulabilityAnalysis();
+
+    /**
+     * @brief Add cyclic interface
+     *
+     * @param name          name of the interface
+     * @param priority      priority of the thread running the interface
+     * @param period_ns     period
+     * @param wcet_ns       worst-case execution time
+     * @param deadline_ns   relative deadline, 0 if equal to the period, not longer than the period
+     * @param cpu           CPU of the thread, ANY_CPU if not pinned
+     *
+     * @return identifier of the interface
+     */
+    InterfaceId add_cyclic(const char* name,
+                           int priority,
+                           uint64_t period_ns,
+                           uint64_t wcet_ns,
+                           uint64_t deadline_ns = 0,
+                           int cpu = ANY_CPU);
+
+    /**
+     * @brief Add sporadic interface
+     *
+     * @param name                      name of the interface
+     * @param priority                  priority of the thread running the interface
+     * @param minimum_interarrival_ns   minimum time between two requests
+     * @param wcet_ns                   worst-case execution time
+     * @param deadline_ns               relative deadline, 0 if equal to the minimum inter-arrival time,
+     *                                  not longer than the minimum inter-arrival time
+     * @param cpu                       CPU of the thread, ANY_CPU if not pinned
+     *
+     * @return identifier of the interface
+     */
+    InterfaceId add_sporadic(const char* name,
+                             int priority,
+                             uint64_t minimum_interarrival_ns,
+                             uint64_t wcet_ns,
+                             uint64_t deadline_ns = 0,
+                             int cpu = ANY_CPU);
+
+    /**
+     * @brief Set blocking time of the interface
+     *
+     * @param interface     identifier of the interface
+     * @param blocking_ns   longest time the interface waits for lower priority interfaces
+     */
+    void set_blocking(InterfaceId interface, uint64_t blocking_ns);
+
+    /**
+     * @brief Use measured execution time as worst-case execution time
+     *
+     * The larger of declared and measured CPU time is used.
+     *
+     * @param interface     identifier of the interface
+     * @param statistics    statistics of the interface collected by ExecutionStatistics
+     */
+    void use_measured_wcet(InterfaceId interface, const ExecutionStatistics::Summary& statistics);
+
+    /**
+     * @brief Compute response times with the declared priorities
+     *
+     * @return true if all interfaces meet their deadlines, otherwise false
+     */
+    bool analyze();
+
+    /**
+     * @brief Compute deadline-monotonic priorities
+     *
+     * The interface with the shortest deadline gets the highest priority,
+     * interfaces with equal deadlines get equal priorities. When there are
+     * more deadlines than priority levels, the longest deadlines share the
+     * lowest priority.
+     *
+     * @param highest_priority  highest priority to assign
+     * @param lowest_priority   lowest priority to assign
+     *
+     * @return true if all interfaces meet their deadlines with suggested priorities
+     */
+    bool suggest_priorities(int highest_priority, int lowest_priority);
+
+    /**
+     * @brief Get worst-case response time computed by analyze
+     *
+     * @param interface     identifier of the interface
+     *
+     * @return response time, greater than the deadline if it is missed,
+     *         only approximate if the interface is not pinned to a CPU
+     */
+    uint64_t response_time(InterfaceId interface) const;
+
+    /**
+     * @brief Get priority computed by suggest_priorities
+     *
+     * @param interface     identifier of the interface
+     *
+     * @return suggested priority
+     */
+    int suggested_priority(InterfaceId interface) const;
+
+    /**
+     * @brief Get utilization of the CPU
+     *
+     * @param cpu           index of the CPU, or ANY_CPU
+     *
+     * @return sum of utilizations of interfaces on the CPU, 1.0 is fully loaded CPU
+     */
+    double utilization(int cpu) const;
+
+    /**
+     * @brief Print response times, CPU utilization and suggested priorities
+     *
+     * @param stream    output stream
+     */
+    void print_report(std::ostream& stream) const;
+
+    /**
+     * @brief Analyze configuration before the start of the system
+     *
+     * The report is printed if the configuration is unschedulable. Then,
+     * the program is terminated if RT_SCHEDULABILITY_ENFORCE is defined,
+     * otherwise only the warning is printed. If RT_SCHEDULABILITY_ENFORCE
+     * is defined, the program is also terminated if any interface is not
+     * pinned to a CPU, as its response time is only approximate.
+     *
+     * @param highest_priority  highest priority used for suggested priorities
+     * @param lowest_priority   lowest priority used for suggested priorities
+     *
+     * @return true if the configuration is schedulable, otherwise false
+     */
+    bool verify(int highest_priority, int lowest_priority);
+
+  private:
+    struct Interface
+    {
+        const char* name;
+        bool cyclic;
+        int priority;
+        uint64_t period_ns;
+        uint64_t wcet_ns;
+        uint64_t deadline_ns;
+        uint64_t blocking_ns;
+        int cpu;
+        uint64_t response_time_ns;
+        int suggested_priority;
+        uint64_t suggested_response_time_ns;
+    };
+
+    InterfaceId add_interface(const char* name,
+                              bool cyclic,
+                              int priority,
+                              uint64_t period_ns,
+                              uint64_t wcet_ns,
+                              uint64_t deadline_ns,
+                              int cpu);
+    void check_interface(InterfaceId interface) const;
+    static bool may_interfere(const Interface& other, const Interface& analyzed);
+    static void print_response_time(std::ostream& stream, const Interface& interface, uint64_t response_time_ns);
+    uint64_t compute_response_time(InterfaceId interface, const std::vector<int>& priorities) const;
+    bool compute_response_times(const std::vector<int>& priorities, std::vector<uint64_t>& response_times) const;
+    std::vector<int> cpus() const;
+
+  private:
+    std::vector<Interface> m_interfaces;
+    bool m_analyzed;
+    bool m_priorities_suggested;
+};
+} // namespace taste
+
+#endif
@@ -0,0 +1,244 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ScheduleTable.h"
+
+#include "Metrics.h"
+#include "StartBarrier.h"
+#include "Timer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+namespace taste {
+namespace {
+uint64_t
+to_ns(std::chrono::steady_clock::duration duration)
+{
+    const auto count = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    return count > 0 ? static_cast<uint64_t>(count) : 0;
+}
+} // namespace
+
+ScheduleTable::ScheduleTable(std::chrono::nanoseconds major_frame, std::chrono::nanoseconds minor_frame)
+    : m_major_frame(major_frame)
+    , m_minor_frame(minor_frame)
+{
+}
+
+void
+ScheduleTable::add_slot(int cpu,
+                        std::chrono::nanoseconds offset,
+                        std::chrono::nanoseconds budget,
+                        const char* name,
+                        Callback callback,
+                        void* param)
+{
+    Slot slot;
+    slot.name = name;
+    slot.cpu = cpu;
+    slot.offset = offset;
+    slot.budget = budget;
+    slot.callback = callback;
+    slot.param = param;
+    m_slots.push_back(slot);
+}
+
+void
+ScheduleTable::start(int priority, size_t stack_size)
+{
+    validate();
+
+    m_statistics.reset(new SlotStatistics[m_slots.size()]);
+    for(size_t i = 0; i < m_slots.size(); ++i) {
+        m_statistics[i].activations = 0;
+        m_statistics[i].overruns = 0;
+        m_statistics[i].skipped = 0;
+        m_statistics[i].max_execution_ns = 0;
+        m_statistics[i].max_lateness_ns = 0;
+#ifdef RT_ENABLE_METRICS
+        m_statistics[i].metrics = Metrics::register_timer(m_slots[i].name, to_ns(m_major_frame));
+#endif
+
+        auto executive = std::find_if(m_executives.begin(), m_executives.end(), [this, i](const Executive& e) {
+            return e.cpu == m_slots[i].cpu;
+        });
+        if(executive == m_executives.end()) {
+            Executive new_executive;
+            new_executive.table = this;
+            new_executive.cpu = m_slots[i].cpu;
+            m_executives.push_back(std::move(new_executive));
+            executive = m_executives.end() - 1;
+        }
+        executive->slots.push_back(i);
+    }
+
+    for(Executive& executive : m_executives) {
+        std::sort(executive.slots.begin(), executive.slots.end(), [this](size_t lhs, size_t rhs) {
+            return m_slots[lhs].offset < m_slots[rhs].offset;
+        });
+        executive.thread.reset(new Thread(priority, stack_size, "executive"));
+        executive.thread->set_cpu(executive.cpu);
+    }
+    // executives are started after the vector is complete, as they keep pointers to its elements
+    for(Executive& executive : m_executives) {
+        executive.thread->start(&ScheduleTable::run_executive, &executive);
+    }
+}
+
+uint64_t
+ScheduleTable::overrun_count(size_t index) const
+{
+    return m_statistics[index].overruns.load(std::memory_order_relaxed);
+}
+
+uint64_t
+ScheduleTable::skipped_count(size_t index) const
+{
+    return m_statistics[index].skipped.load(std::memory_order_relaxed);
+}
+
+void
+ScheduleTable::print_statistics(std::ostream& stream) const
+{
+    constexpr uint64_t NANOSECONDS_IN_MICROSECOND = 1000;
+
+    stream << "Schedule table statistics:" << std::endl;
+    for(size_t i = 0; i < m_slots.size(); ++i) {
+        const SlotStatistics& statistics = m_statistics[i];
+        stream << "  " << m_slots[i].name << " (cpu " << m_slots[i].cpu
+               << "): activations " << statistics.activations.load(std::memory_order_relaxed) << ", overruns "
+               << statistics.overruns.load(std::memory_order_relaxed) << ", skipped "
+               << statistics.skipped.load(std::memory_order_relaxed) << ", max execution "
+               << statistics.max_execution_ns.load(std::memory_order_relaxed) / NANOSECONDS_IN_MICROSECOND
+               << " us of " << to_ns(m_slots[i].budget) / NANOSECONDS_IN_MICROSECOND << " us, max lateness "
+               << statistics.max_lateness_ns.load(std::memory_order_relaxed) / NANOSECONDS_IN_MICROSECOND << " us"
+               << std::endl;
+    }
+}
+
+void
+ScheduleTable::validate()
+{
+    if(m_minor_frame.count() <= 0 || m_major_frame.count() % m_minor_frame.count() != 0) {
+        std::cerr << "Major frame of schedule table shall be a multiple of minor frame" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    for(size_t i = 0; i < m_slots.size(); ++i) {
+        const Slot& slot = m_slots[i];
+        const auto end = slot.offset + slot.budget;
+        if(slot.offset.count() < 0 || slot.budget.count() <= 0 || end > m_major_frame) {
+            std::cerr << "Slot '" << slot.name << "' does not fit in the major frame" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        if(slot.offset / m_minor_frame != (end - std::chrono::nanoseconds(1)) / m_minor_frame) {
+            std::cerr << "Slot '" << slot.name << "' crosses the boundary of minor frame" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        for(size_t j = 0; j < i; ++j) {
+            const Slot& other = m_slots[j];
+            if(other.cpu == slot.cpu && slot.offset < other.offset + other.budget && other.offset < end) {
+                std::cerr << "Slots '" << other.name << "' and '" << slot.name << "' overlap on cpu " << slot.cpu
+                          << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+}
+
+void
+ScheduleTable::run_executive(void* param)
+{
+    Executive& executive = *static_cast<Executive*>(param);
+    ScheduleTable& table = *executive.table;
+
+    StartBarrier::wait();
+
+    // frames which already passed are skipped, the schedule stays aligned to the start time
+    const auto start_time = Timer::global_start_time();
+    const auto elapsed = std::chrono::steady_clock::now() - start_time;
+    auto frame_start = start_time + (elapsed / table.m_major_frame + 1) * table.m_major_frame;
+
+    while(true) {
+        for(size_t position = 0; position < executive.slots.size(); ++position) {
+            const auto now = std::chrono::steady_clock::now();
+            if(now > frame_start + table.m_major_frame) {
+                // after an overrun longer than a frame, the schedule resumes at the next frame boundary
+                // instead of running the missed slots back-to-back
+                const auto frames_behind = (now - frame_start) / table.m_major_frame;
+                table.skip_slots(executive, position, static_cast<uint64_t>(frames_behind));
+                frame_start += frames_behind * table.m_major_frame;
+                break;
+            }
+            const size_t index = executive.slots[position];
+            table.run_slot(index, frame_start + table.m_slots[index].offset);
+        }
+        frame_start += table.m_major_frame;
+    }
+}
+
+void
+ScheduleTable::skip_slots(const Executive& executive, size_t position, uint64_t skipped_frames)
+{
+    for(size_t i = 0; i < executive.slots.size(); ++i) {
+        SlotStatistics& statistics = m_statistics[executive.slots[i]];
+        const uint64_t skipped = skipped_frames + (i >= position ? 1 : 0);
+        statistics.skipped.store(statistics.skipped.load(std::memory_order_relaxed) + skipped,
+                                 std::memory_order_relaxed);
+    }
+}
+
+void
+ScheduleTable::run_slot(size_t index, std::chrono::steady_clock::time_point start_time)
+{
+    const Slot& slot = m_slots[index];
+    SlotStatistics& statistics = m_statistics[index];
+
+    std::this_thread::sleep_until(start_time);
+    const auto activation_time = std::chrono::steady_clock::now();
+    slot.callback(slot.param);
+    const auto end_time = std::chrono::steady_clock::now();
+
+    const uint64_t lateness_ns = to_ns(activation_time - start_time);
+    statistics.activations.store(statistics.activations.load(std::memory_order_relaxed) + 1,
+                                 std::memory_order_relaxed);
+    Metrics::update_maximum(statistics.max_execution_ns, to_ns(end_time - activation_time));
+    Metrics::update_maximum(statistics.max_lateness_ns, lateness_ns);
+    const bool overrun = end_time > start_time + slot.budget;
+    if(overrun) {
+        statistics.overruns.store(statistics.overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+#ifdef RT_ENABLE_METRICS
+    if(statistics.metrics != nullptr) {
+        Metrics::add(statistics.metrics->activations);
+        Metrics::update_maximum(statistics.metrics->max_lateness_ns, lateness_ns);
+        if(overrun) {
+            Metrics::add(statistics.metrics->overruns);
+        }
+    }
+#endif
+}
+} // namespace taste
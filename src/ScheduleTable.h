@@ -0,0 +1,214 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_SCHEDULE_TABLE_H
+#define TASTE_SCHEDULE_TABLE_H
+
+/**
+ * @file    ScheduleTable.h
+ * @brief   Time-triggered executive running a static schedule table.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "Thread.h"
+
+#ifdef RT_ENABLE_METRICS
+#include "Metrics.h"
+#endif
+
+namespace taste {
+/**
+ * @brief Time-triggered executive of cyclic and sporadic interfaces.
+ *
+ * The schedule is divided into major frames, which repeat forever, and each
+ * major frame is divided into minor frames. Slots are placed at fixed offsets
+ * in the major frame and have a time budget, a slot shall not cross the
+ * boundary of a minor frame and slots on the same CPU shall not overlap.
+ * Sporadic interfaces are polled in reserved slots using SporadicPoller,
+ * declared in SporadicPoller.h.
+ *
+ * Each CPU used by the table is served by one thread pinned to that CPU,
+ * which runs its slots in order, without preemption by other runtime threads.
+ * The first major frame starts at the global start time of Timer. Executive
+ * threads call StartBarrier::wait before the first frame, so they shall be
+ * counted in StartBarrier::initialize. Frames which passed during the startup
+ * are skipped.
+ *
+ * A slot which does not finish within its budget is counted as an overrun,
+ * the following slots run late in that case. If the executive falls behind
+ * by more than a major frame, it resumes at the next frame boundary and
+ * the slots it passed are counted as skipped. If RT_ENABLE_METRICS is defined,
+ * slots are published as timers in Metrics.
+ */
+class ScheduleTable final
+{
+  public:
+    /**
+     * @brief Type definition of slot callback
+     */
+    using Callback = void (*)(void* param);
+
+    /**
+     * @brief Constructor
+     *
+     * @param major_frame   duration of the major frame
+     * @param minor_frame   duration of the minor frame, major frame shall be its multiple
+     */
+    ScheduleTable(std::chrono::nanoseconds major_frame, std::chrono::nanoseconds minor_frame);
+
+    /// @brief deleted copy constructor
+    ScheduleTable(const ScheduleTable&) = delete;
+
+    /// @brief deleted move constructor
+    ScheduleTable(ScheduleTable&&) = delete;
+
+    /// @brief deleted copy assignment operator
+    ScheduleTable& operator=(const ScheduleTable&) = delete;
+
+    /// @brief deleted move assignment operator
+    ScheduleTable& operator=(ScheduleTable&&) = delete;
+
+    /**
+     * @brief Add slot to the table
+     *
+     * @param cpu       index of the CPU which executes the slot
+     * @param offset    start of the slot within the major frame
+     * @param budget    maximum execution time of the slot
+     * @param name      name of the slot, used in statistics
+     * @param callback  function executed in the slot
+     * @param param     parameter of the callback
+     */
+    void add_slot(int cpu,
+                  std::chrono::nanoseconds offset,
+                  std::chrono::nanoseconds budget,
+                  const char* name,
+                  Callback callback,
+                  void* param);
+
+    /**
+     * @brief Add slot polling a sporadic queue to the table
+     *
+     * @tparam POLLER   Type of the poller, e.g. SporadicPoller
+     * @param cpu       index of the CPU which executes the slot
+     * @param offset    start of the slot within the major frame
+     * @param budget    maximum execution time of the slot
+     * @param name      name of the slot, used in statistics
+     * @param poller    poller of the queue, shall outlive the table
+     */
+    template<typename POLLER>
+    void add_sporadic_slot(int cpu,
+                           std::chrono::nanoseconds offset,
+                           std::chrono::nanoseconds budget,
+                           const char* name,
+                           POLLER& poller)
+    {
+        add_slot(cpu, offset, budget, name, &POLLER::poll, &poller);
+    }
+
+    /**
+     * @brief Validate the table and start executive threads
+     *
+     * Terminates the program if the table is invalid.
+     *
+     * @param priority      priority of executive threads
+     * @param stack_size    stack size of executive threads in bytes
+     */
+    void start(int priority, size_t stack_size);
+
+    /**
+     * @brief Get number of overruns of the slot
+     *
+     * @param index     index of the slot, in order of addition
+     *
+     * @return number of activations which exceeded the budget
+     */
+    uint64_t overrun_count(size_t index) const;
+
+    /**
+     * @brief Get number of skipped activations of the slot
+     *
+     * @param index     index of the slot, in order of addition
+     *
+     * @return number of activations skipped after the executive fell behind by more than a major frame
+     */
+    uint64_t skipped_count(size_t index) const;
+
+    /**
+     * @brief Print activations, overruns, skipped activations and execution times of slots
+     *
+     * @param stream    output stream
+     */
+    void print_statistics(std::ostream& stream) const;
+
+  private:
+    struct Slot
+    {
+        const char* name;
+        int cpu;
+        std::chrono::nanoseconds offset;
+        std::chrono::nanoseconds budget;
+        Callback callback;
+        void* param;
+    };
+
+    struct SlotStatistics
+    {
+        std::atomic<uint64_t> activations;
+        std::atomic<uint64_t> overruns;
+        std::atomic<uint64_t> skipped;
+        std::atomic<uint64_t> max_execution_ns;
+        std::atomic<uint64_t> max_lateness_ns;
+#ifdef RT_ENABLE_METRICS
+        TimerMetrics* metrics;
+#endif
+    };
+
+    struct Executive
+    {
+        ScheduleTable* table;
+        int cpu;
+        std::vector<size_t> slots;
+        std::unique_ptr<Thread> thread;
+    };
+
+    void validate();
+    static void run_executive(void* param);
+    void skip_slots(const Executive& executive, size_t position, uint64_t skipped_frames);
+    void run_slot(size_t index, std::chrono::steady_clock::time_point start_time);
+
+  private:
+    const std::chrono::nanoseconds m_major_frame;
+    const std::chrono::nanoseconds m_minor_frame;
+    std::vector<Slot> m_slots;
+    std::unique_ptr<SlotStatistics[]> m_statistics;
+    std::vector<Executive> m_executives;
+};
+} // namespace taste
+
+#endif
@@ -0,0 +1,145 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Semaphore.h"
+
+#include <cerrno>
+#include <ctime>
+#include <iostream>
+#include <limits>
+
+namespace taste {
+namespace {
+constexpr uint64_t NANOSECONDS_IN_SECOND = 1000000000ULL;
+}
+
+Semaphore::Semaphore(const uint32_t initial_count, const uint32_t max_count)
+    : m_count(initial_count)
+    , m_max_count(max_count)
+{
+    pthread_mutexattr_t mutex_attributes;
+    pthread_mutexattr_init(&mutex_attributes);
+    int res = pthread_mutexattr_setprotocol(&mutex_attributes, PTHREAD_PRIO_INHERIT);
+    if(res != 0) {
+        std::cerr << "Unable to set priority inheritance protocol in semaphore mutex attributes" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    res = pthread_mutex_init(&m_mutex, &mutex_attributes);
+    pthread_mutexattr_destroy(&mutex_attributes);
+    if(res != 0) {
+        std::cerr << "Unable to initialize semaphore mutex" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    pthread_condattr_t condition_attributes;
+    pthread_condattr_init(&condition_attributes);
+    res = pthread_condattr_setclock(&condition_attributes, CLOCK_MONOTONIC);
+    if(res != 0) {
+        std::cerr << "Unable to set clock in semaphore condition attributes" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    res = pthread_cond_init(&m_condition, &condition_attributes);
+    pthread_condattr_destroy(&condition_attributes);
+    if(res != 0) {
+        std::cerr << "Unable to initialize semaphore condition variable" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+Semaphore::~Semaphore()
+{
+    pthread_cond_destroy(&m_condition);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void
+Semaphore::reset(const uint32_t count, const uint32_t max_count)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_count = count;
+    m_max_count = max_count;
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void
+Semaphore::obtain()
+{
+    pthread_mutex_lock(&m_mutex);
+    while(m_count == 0) {
+        pthread_cond_wait(&m_condition, &m_mutex);
+    }
+    m_count--;
+    pthread_mutex_unlock(&m_mutex);
+}
+
+bool
+Semaphore::try_obtain()
+{
+    pthread_mutex_lock(&m_mutex);
+    const bool obtained = m_count > 0;
+    if(obtained) {
+        m_count--;
+    }
+    pthread_mutex_unlock(&m_mutex);
+
+    return obtained;
+}
+
+bool
+Semaphore::obtain(const uint64_t timeout_ns)
+{
+    timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    const uint64_t nanoseconds = static_cast<uint64_t>(deadline.tv_nsec) + timeout_ns % NANOSECONDS_IN_SECOND;
+    deadline.tv_sec += static_cast<time_t>(timeout_ns / NANOSECONDS_IN_SECOND + nanoseconds / NANOSECONDS_IN_SECOND);
+    deadline.tv_nsec = static_cast<long>(nanoseconds % NANOSECONDS_IN_SECOND);
+
+    pthread_mutex_lock(&m_mutex);
+    int res = 0;
+    while(m_count == 0 && res != ETIMEDOUT) {
+        res = pthread_cond_timedwait(&m_condition, &m_mutex, &deadline);
+    }
+    const bool obtained = m_count > 0;
+    if(obtained) {
+        m_count--;
+    }
+    pthread_mutex_unlock(&m_mutex);
+
+    return obtained;
+}
+
+bool
+Semaphore::release()
+{
+    pthread_mutex_lock(&m_mutex);
+    if(m_count >= m_max_count) {
+        pthread_mutex_unlock(&m_mutex);
+        return false;
+    }
+    m_count++;
+    pthread_mutex_unlock(&m_mutex);
+
+    pthread_cond_signal(&m_condition);
+
+    return true;
+}
+} // namespace taste
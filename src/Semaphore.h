@@ -0,0 +1,119 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_SEMAPHORE_H
+#define TASTE_SEMAPHORE_H
+
+/**
+ * @file    Semaphore.h
+ * @brief   Counting semaphore used by Hal.
+ */
+
+#include <cstdint>
+#include <limits>
+#include <pthread.h>
+
+namespace taste {
+/**
+ * @brief Counting semaphore with timed and non-blocking obtain.
+ *
+ * Unlike a mutex, the semaphore can be released by a thread different from
+ * the one which obtained it. The internal mutex uses priority inheritance,
+ * so a low priority thread updating the counter cannot indefinitely block
+ * a high priority waiter. Timeouts are measured against CLOCK_MONOTONIC.
+ * The counter is limited by the maximum count, a semaphore with maximum
+ * count 1 is a binary semaphore.
+ */
+class Semaphore final
+{
+  public:
+    /**
+     * @brief Constructor
+     *
+     * @param initial_count  Initial value of the counter
+     * @param max_count      Maximum value of the counter
+     */
+    explicit Semaphore(const uint32_t initial_count = 0,
+                       const uint32_t max_count = std::numeric_limits<uint32_t>::max());
+
+    /// @brief destructor
+    ~Semaphore();
+
+    /// @brief deleted copy constructor
+    Semaphore(const Semaphore&) = delete;
+
+    /// @brief deleted move constructor
+    Semaphore(Semaphore&&) = delete;
+
+    /// @brief deleted copy assignment operator
+    Semaphore& operator=(const Semaphore&) = delete;
+
+    /// @brief deleted move assignment operator
+    Semaphore& operator=(Semaphore&&) = delete;
+
+    /**
+     * @brief Set the counter value
+     *
+     * This shall be used only when there are no waiting threads.
+     *
+     * @param count       new counter value
+     * @param max_count   new maximum value of the counter
+     */
+    void reset(const uint32_t count, const uint32_t max_count = std::numeric_limits<uint32_t>::max());
+
+    /**
+     * @brief Decrement the counter, waiting until it is greater than zero.
+     */
+    void obtain();
+
+    /**
+     * @brief Decrement the counter if it is greater than zero.
+     *
+     * @return true if the semaphore was obtained, otherwise false
+     */
+    bool try_obtain();
+
+    /**
+     * @brief Decrement the counter, waiting at most for the given time.
+     *
+     * @param timeout_ns   maximum waiting time in nanoseconds
+     *
+     * @return true if the semaphore was obtained, false on timeout
+     */
+    bool obtain(const uint64_t timeout_ns);
+
+    /**
+     * @brief Increment the counter and wake up one waiting thread.
+     *
+     * @return true on success, false if the counter would exceed the maximum count
+     */
+    bool release();
+
+  private:
+    uint32_t m_count;
+    uint32_t m_max_count;
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_condition;
+};
+} // namespace taste
+
+#endif
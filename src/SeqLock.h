@@ -0,0 +1,166 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_SEQ_LOCK_H
+#define TASTE_SEQ_LOCK_H
+
+/**
+ * @file    SeqLock.h
+ * @brief   Read-mostly protection for TASTE function blocks.
+ */
+
+#include <atomic>
+#include <cstdint>
+
+#include "Lock.h"
+
+/// Number of optimistic read attempts before the reader takes the exclusive lock
+#ifndef RT_SEQLOCK_READ_RETRIES
+#define RT_SEQLOCK_READ_RETRIES 16
+#endif
+
+namespace taste {
+/**
+ * @brief Sequence lock for read-mostly protected functions.
+ *
+ * Writers take the exclusive Lock and increment the sequence counter before
+ * and after modification. Readers do not take any lock, they run optimistically
+ * and retry when a writer was active during the read. After
+ * RT_SEQLOCK_READ_RETRIES failed attempts, including attempts which found
+ * a writer holding the lock, the reader takes the exclusive lock.
+ *
+ * A reader may observe inconsistent state, which is discarded after the
+ * retry check. Therefore readers shall only copy the state out, without side
+ * effects and without following pointers read from the protected state.
+ */
+class SeqLock final
+{
+  public:
+    /**
+     * @brief Default constructor.
+     *
+     * Constructed lock is in 'unlocked' state.
+     */
+    SeqLock();
+
+    /**
+     * @brief Constructor.
+     *
+     * Constructed lock is in 'unlocked' state.
+     *
+     * @param name              name of the lock used in statistics
+     * @param policy            locking policy of writers
+     */
+    explicit SeqLock(const char* name, const Lock::Policy policy = Lock::Policy::RT_DEFAULT_LOCK_POLICY);
+
+    /// @brief deleted copy constructor
+    SeqLock(const SeqLock&) = delete;
+
+    /// @brief deleted move constructor
+    SeqLock(SeqLock&&) = delete;
+
+    /// @brief deleted copy assignment operator
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    /// @brief deleted move assignment operator
+    SeqLock& operator=(SeqLock&&) = delete;
+
+    /// @brief acquire lock for writing
+    void lock();
+    /// @brief release lock after writing
+    void unlock();
+
+    /**
+     * @brief Start optimistic read.
+     *
+     * Does not wait for the writer, a reader preempting the writer on the
+     * same CPU would never let it finish. If a writer holds the lock, the
+     * returned value is odd and read_retry reports the read as failed.
+     *
+     * @return sequence value to be passed to read_retry
+     */
+    uint32_t read_begin() const;
+
+    /**
+     * @brief Finish optimistic read.
+     *
+     * @param sequence  value returned by read_begin
+     *
+     * @return true if a writer was active during the read and the read shall be repeated
+     */
+    bool read_retry(uint32_t sequence) const;
+
+    /**
+     * @brief Execute reader, retrying until it observes consistent state.
+     *
+     * @tparam T        callback type
+     * @param reader    function like object copying the protected state
+     */
+    template<typename T>
+    void read(T reader);
+
+  private:
+    Lock m_lock;
+    std::atomic<uint32_t> m_sequence;
+};
+
+inline uint32_t
+SeqLock::read_begin() const
+{
+    return m_sequence.load(std::memory_order_acquire);
+}
+
+inline bool
+SeqLock::read_retry(uint32_t sequence) const
+{
+    if((sequence & 1U) != 0) {
+        return true;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return m_sequence.load(std::memory_order_relaxed) != sequence;
+}
+
+template<typename T>
+void
+SeqLock::read(T reader)
+{
+    for(int attempt = 0; attempt < RT_SEQLOCK_READ_RETRIES; ++attempt) {
+        const uint32_t sequence = read_begin();
+        if((sequence & 1U) != 0) {
+            // a writer is active, which counts as a failed attempt
+            continue;
+        }
+        reader();
+        if(!read_retry(sequence)) {
+            return;
+        }
+    }
+
+    // writers are too frequent or preempted while writing, fall back to the exclusive lock
+    m_lock.lock();
+    reader();
+    m_lock.unlock();
+}
+
+} // namespace taste
+
+#endif
@@ -0,0 +1,73 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SingleThreaded.h"
+
+#include <cstdlib>
+#include <iostream>
+
+#include <dirent.h>
+
+namespace taste {
+void
+SingleThreaded::register_thread()
+{
+    if(m_started_threads.fetch_add(1) != 0) {
+        std::cerr << "Only one runtime thread can be started in single-threaded build" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+void
+SingleThreaded::verify()
+{
+    DIR* directory = opendir("/proc/self/task");
+    if(directory == nullptr) {
+        std::cerr << "Unable to verify number of threads" << std::endl;
+        return;
+    }
+    unsigned int thread_count = 0;
+    while(const dirent* entry = readdir(directory)) {
+        if(entry->d_name[0] != '.') {
+            ++thread_count;
+        }
+    }
+    closedir(directory);
+
+    // the main thread may wait for the runtime thread
+    const unsigned int allowed_thread_count = 1 + m_started_threads.load();
+    if(thread_count > allowed_thread_count) {
+        std::cerr << thread_count << " threads run in single-threaded build, " << allowed_thread_count
+                  << " are allowed" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+void
+SingleThreaded::report_blocking_wait()
+{
+    std::cerr << "Waiting for an empty queue would never end in single-threaded build" << std::endl;
+    exit(EXIT_FAILURE);
+}
+
+std::atomic<unsigned int> SingleThreaded::m_started_threads(0);
+} // namespace taste
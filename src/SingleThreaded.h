@@ -0,0 +1,158 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_SINGLE_THREADED_H
+#define TASTE_SINGLE_THREADED_H
+
+/**
+ * @file    SingleThreaded.h
+ * @brief   Support of partitions running on a single thread.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace taste {
+/**
+ * @brief Single-threaded build mode.
+ *
+ * If RT_SINGLE_THREADED is defined, Lock, broker locks and Queue do not
+ * synchronize, their operations are inline or empty. At most one runtime
+ * thread may be started using Thread, and StartBarrier checks that no other
+ * threads run in the process, apart from the main thread.
+ */
+class SingleThreaded final
+{
+  public:
+    /**
+     * @brief Deleted default constructor.
+     */
+    SingleThreaded() = delete;
+
+    /**
+     * @brief Check if the single-threaded mode is enabled.
+     *
+     * @return true if RT_SINGLE_THREADED is defined, otherwise false
+     */
+    static constexpr bool is_enabled()
+    {
+#ifdef RT_SINGLE_THREADED
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Register start of runtime thread.
+     *
+     * Terminates the program if more than one runtime thread is started.
+     */
+    static void register_thread();
+
+    /**
+     * @brief Check that only one thread runs the partition.
+     *
+     * Terminates the program if other threads run in the process.
+     */
+    static void verify();
+
+    /**
+     * @brief Report wait which would never end.
+     *
+     * Terminates the program.
+     */
+    [[noreturn]] static void report_blocking_wait();
+
+  private:
+    static std::atomic<unsigned int> m_started_threads;
+};
+
+/**
+ * @brief Mutex which does not synchronize, used in single-threaded mode.
+ */
+class NullMutex final
+{
+  public:
+    /// @brief lock the mutex, does nothing
+    void lock() {}
+
+    /// @brief unlock the mutex, does nothing
+    void unlock() {}
+};
+
+/**
+ * @brief Condition variable which does not synchronize, used in single-threaded mode.
+ *
+ * There are no other threads to wait for, so waiting terminates the program.
+ */
+class NullConditionVariable final
+{
+  public:
+    /// @brief notify one waiting thread, does nothing
+    void notify_one() {}
+
+    /// @brief notify all waiting threads, does nothing
+    void notify_all() {}
+
+    /**
+     * @brief wait for notification
+     *
+     * @param lock  lock of the protected state
+     */
+    template<typename LOCK>
+    void wait(LOCK& lock)
+    {
+        (void)lock;
+        SingleThreaded::report_blocking_wait();
+    }
+
+    /**
+     * @brief wait for notification or timeout
+     *
+     * @param lock     lock of the protected state
+     * @param timeout  maximum waiting time
+     */
+    template<typename LOCK, typename DURATION>
+    void wait_for(LOCK& lock, const DURATION& timeout)
+    {
+        (void)lock;
+        (void)timeout;
+        SingleThreaded::report_blocking_wait();
+    }
+};
+
+#ifdef RT_SINGLE_THREADED
+/// Mutex protecting state shared between runtime threads
+using RuntimeMutex = NullMutex;
+/// Condition variable used to wait for state shared between runtime threads
+using RuntimeConditionVariable = NullConditionVariable;
+#else
+/// Mutex protecting state shared between runtime threads
+using RuntimeMutex = std::mutex;
+/// Condition variable used to wait for state shared between runtime threads
+using RuntimeConditionVariable = std::condition_variable;
+#endif
+} // namespace taste
+
+#endif
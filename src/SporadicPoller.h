@@ -0,0 +1,107 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_SPORADIC_POLLER_H
+#define TASTE_SPORADIC_POLLER_H
+
+/**
+ * @file    SporadicPoller.h
+ * @brief   Polling of sporadic queues in slots of ScheduleTable.
+ */
+
+#include <cstddef>
+
+#include "Queue.h"
+#include "Request.h"
+
+#ifdef RT_EXECUTION_PROFILING
+#include "ExecutionStatistics.h"
+#endif
+
+namespace taste {
+/**
+ * @brief Polls a sporadic queue in a slot of ScheduleTable.
+ *
+ * Each activation processes requests available in the queue,
+ * up to the given limit, without waiting for new requests.
+ *
+ * If RT_EXECUTION_PROFILING is defined, each handler call is measured
+ * using ExecutionStatistics, from the moment the request is taken from queue.
+ *
+ * @tparam PARAMETER_SIZE The maximum size of single request in bytes.
+ */
+template<size_t PARAMETER_SIZE>
+class SporadicPoller final
+{
+  public:
+    /**
+     * @brief Type definition of request handler function
+     */
+    using Handler = void (*)(const Request<PARAMETER_SIZE>& request);
+
+    /**
+     * @brief Constructor
+     *
+     * @param queue          Queue of the sporadic interface
+     * @param handler        Function called for each request
+     * @param max_requests   Maximum number of requests processed in one slot
+     * @param name           Name of the interface, used in statistics
+     */
+    SporadicPoller(Queue<PARAMETER_SIZE>& queue, Handler handler, size_t max_requests, const char* name = nullptr)
+        : m_queue(queue)
+        , m_handler(handler)
+        , m_max_requests(max_requests)
+#ifdef RT_EXECUTION_PROFILING
+        , m_statistics(name)
+#endif
+    {
+        (void)name;
+    }
+
+    /**
+     * @brief Process available requests
+     *
+     * @param param    pointer to SporadicPoller
+     */
+    static void poll(void* param)
+    {
+        SporadicPoller& poller = *static_cast<SporadicPoller*>(param);
+        for(size_t i = 0; i < poller.m_max_requests && poller.m_queue.try_get(poller.m_request); ++i) {
+#ifdef RT_EXECUTION_PROFILING
+            const ExecutionStatistics::Scope scope(poller.m_statistics);
+#endif
+            poller.m_handler(poller.m_request);
+        }
+    }
+
+  private:
+    Queue<PARAMETER_SIZE>& m_queue;
+    const Handler m_handler;
+    const size_t m_max_requests;
+    Request<PARAMETER_SIZE> m_request;
+#ifdef RT_EXECUTION_PROFILING
+    ExecutionStatistics m_statistics;
+#endif
+};
+} // namespace taste
+
+#endif
@@ -21,34 +21,204 @@
  */
 
 #include "StartBarrier.h"
+
+#include "Clock.h"
+#include "MemoryReport.h"
+#include "SingleThreaded.h"
+
+#ifdef RT_ALLOCATION_TRACKER
+#include "AllocationTracker.h"
+#endif
+
+#include <algorithm>
 #include <iostream>
+#include <utility>
 
 namespace taste {
 void
 StartBarrier::initialize(size_t number, InitCallback init_callback)
 {
-    m_init_callback = init_callback;
+    if(!init_callback) {
+        std::cerr << "Init callback of StartBarrier shall not be empty" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    m_init_callback = std::move(init_callback);
 
     const int error_code = pthread_barrier_init(&m_init_barrier, nullptr, number);
     if(error_code != 0) {
         std::cerr << "Barrier has not been created properly. Error code : " << error_code << std::endl;
         exit(EXIT_FAILURE);
     }
+
+    // initializers are ordered by level, phases of the same level run together
+    size_t level_count = 0;
+    for(const Phase& phase : m_phases) {
+        level_count = std::max(level_count, phase.level + 1);
+    }
+    m_initializer_order.clear();
+    m_levels.clear();
+    for(size_t level = 0; level < level_count; ++level) {
+        Level range;
+        range.begin = m_initializer_order.size();
+        for(size_t i = 0; i < m_initializers.size(); ++i) {
+            if(m_phases[m_initializers[i].phase].level == level) {
+                m_initializer_order.push_back(i);
+            }
+        }
+        range.end = m_initializer_order.size();
+        m_levels.push_back(range);
+    }
+    m_next_initializer.reset(new std::atomic<size_t>[level_count]);
+    for(size_t level = 0; level < level_count; ++level) {
+        m_next_initializer[level] = m_levels[level].begin;
+    }
 }
 
 void
 StartBarrier::wait()
+{
+    barrier_wait();
+    // the first released thread records the start, before any thread can print the profile
+    uint64_t unset_time_ns = 0;
+    m_start_time_ns.compare_exchange_strong(unset_time_ns, Clock::now_ns());
+
+    for(size_t level = 0; level < m_levels.size(); ++level) {
+        run_level(level);
+        barrier_wait();
+    }
+
+    std::call_once(m_init_callback_flag, []() {
+        if(SingleThreaded::is_enabled()) {
+            SingleThreaded::verify();
+        }
+        m_init_callback_start_time_ns = Clock::now_ns();
+        m_init_callback();
+        m_init_callback_end_time_ns = Clock::now_ns();
+#ifdef RT_STARTUP_PROFILE
+        print_startup_profile(std::cerr);
+#endif
+#ifdef RT_MEMORY_REPORT
+        MemoryReport::print_at_startup_and_exit();
+#endif
+#ifdef RT_ALLOCATION_TRACKER
+        AllocationTracker::arm();
+#endif
+    });
+}
+
+StartBarrier::PhaseId
+StartBarrier::add_phase(const char* name, std::initializer_list<PhaseId> dependencies)
+{
+    const PhaseId id = m_phases.size();
+
+    Phase phase;
+    phase.name = name;
+    phase.level = 0;
+    for(const PhaseId dependency : dependencies) {
+        // dependencies shall be added first, which also prevents cycles
+        if(dependency >= id) {
+            std::cerr << "Startup phase '" << name << "' depends on unknown phase " << dependency << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        phase.level = std::max(phase.level, m_phases[dependency].level + 1);
+    }
+    m_phases.push_back(phase);
+
+    return id;
+}
+
+void
+StartBarrier::add_initializer(PhaseId phase, const char* function_name, InitCallback initializer)
+{
+    if(phase >= m_phases.size()) {
+        std::cerr << "Initializer of '" << function_name << "' added to unknown phase " << phase << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if(!initializer) {
+        std::cerr << "Initializer of '" << function_name << "' shall not be empty" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    Initializer entry;
+    entry.phase = phase;
+    entry.function_name = function_name;
+    entry.callback = std::move(initializer);
+    entry.start_time_ns = 0;
+    entry.end_time_ns = 0;
+    m_initializers.push_back(std::move(entry));
+}
+
+void
+StartBarrier::print_startup_profile(std::ostream& stream)
+{
+    constexpr uint64_t NANOSECONDS_IN_MICROSECOND = 1000;
+
+    stream << "Startup profile:" << std::endl;
+    for(PhaseId phase = 0; phase < m_phases.size(); ++phase) {
+        uint64_t start_time_ns = UINT64_MAX;
+        uint64_t end_time_ns = 0;
+        for(const Initializer& initializer : m_initializers) {
+            if(initializer.phase == phase) {
+                start_time_ns = std::min(start_time_ns, initializer.start_time_ns);
+                end_time_ns = std::max(end_time_ns, initializer.end_time_ns);
+            }
+        }
+        const uint64_t phase_time_ns = end_time_ns > start_time_ns ? end_time_ns - start_time_ns : 0;
+        stream << "  phase '" << m_phases[phase].name << "' (level " << m_phases[phase].level
+               << "): " << phase_time_ns / NANOSECONDS_IN_MICROSECOND << " us" << std::endl;
+
+        for(const Initializer& initializer : m_initializers) {
+            if(initializer.phase == phase) {
+                stream << "    " << initializer.function_name << ": "
+                       << (initializer.end_time_ns - initializer.start_time_ns) / NANOSECONDS_IN_MICROSECOND << " us"
+                       << std::endl;
+            }
+        }
+    }
+    stream << "  init callback: "
+           << (m_init_callback_end_time_ns - m_init_callback_start_time_ns) / NANOSECONDS_IN_MICROSECOND << " us"
+           << std::endl;
+    stream << "  total: " << (m_init_callback_end_time_ns - m_start_time_ns.load()) / NANOSECONDS_IN_MICROSECOND
+           << " us" << std::endl;
+}
+
+void
+StartBarrier::barrier_wait()
 {
     const int error_code = pthread_barrier_wait(&m_init_barrier);
     if(error_code != PTHREAD_BARRIER_SERIAL_THREAD && error_code != 0) {
         std::cerr << "Barrier Wait has been failed. Error code : " << error_code << std::endl;
         exit(EXIT_FAILURE);
     }
+}
 
-    std::call_once(m_init_callback_flag, m_init_callback);
+void
+StartBarrier::run_level(size_t level)
+{
+    while(true) {
+        const size_t index = m_next_initializer[level].fetch_add(1);
+        if(index >= m_levels[level].end) {
+            return;
+        }
+
+        Initializer& initializer = m_initializers[m_initializer_order[index]];
+        initializer.start_time_ns = Clock::now_ns();
+        initializer.callback();
+        initializer.end_time_ns = Clock::now_ns();
+    }
 }
 
 pthread_barrier_t StartBarrier::m_init_barrier;
 StartBarrier::InitCallback StartBarrier::m_init_callback;
 std::once_flag StartBarrier::m_init_callback_flag;
+
+std::vector<StartBarrier::Phase> StartBarrier::m_phases;
+std::vector<StartBarrier::Initializer> StartBarrier::m_initializers;
+std::vector<size_t> StartBarrier::m_initializer_order;
+std::vector<StartBarrier::Level> StartBarrier::m_levels;
+std::unique_ptr<std::atomic<size_t>[]> StartBarrier::m_next_initializer;
+std::atomic<uint64_t> StartBarrier::m_start_time_ns(0);
+uint64_t StartBarrier::m_init_callback_start_time_ns = 0;
+uint64_t StartBarrier::m_init_callback_end_time_ns = 0;
 } // namespace taste
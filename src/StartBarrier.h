@@ -28,23 +28,48 @@
  * @brief   Implementation of thread barrier for synchronization of TASTE threads.
  */
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <initializer_list>
+#include <memory>
 #include <mutex>
+#include <ostream>
+#include <vector>
 
 #include <pthread.h>
 
 namespace taste {
 /**
  * @brief StartBarrier used to synchronize threads in TASTE
+ *
+ * Optionally, the initialization can be split into named phases. Initializers
+ * of phases run in parallel on all synchronized threads, after all threads
+ * reach the barrier. A phase starts after all phases it depends on are finished.
+ * Time spent in each phase and each initializer is recorded, it can be printed
+ * using print_startup_profile. If RT_STARTUP_PROFILE is defined, the profile
+ * is printed after the initialization.
+ * If RT_MEMORY_REPORT is defined, MemoryReport is printed after the initialization.
+ * If RT_ALLOCATION_TRACKER is defined, AllocationTracker is armed after
+ * the initialization, so allocations in the steady state are reported.
  */
 class StartBarrier
 {
   public:
     /**
      * @brief Type definition of init callback function
+     *
+     * Callbacks are stored during the initialization only, so they do not
+     * allocate memory in the steady state.
      */
     using InitCallback = std::function<void()>;
 
+    /**
+     * @brief Type definition of startup phase identifier
+     */
+    using PhaseId = size_t;
+
     /**
      * @brief Deleted default constructor.
      */
@@ -62,14 +87,79 @@ class StartBarrier
      */
     static void initialize(size_t number, InitCallback init_callback);
     /**
-     * @brief wait for all threads to reach this point and call init callback
+     * @brief wait for all threads to reach this point, run startup phases and call init callback
      */
     static void wait();
 
+    /**
+     * @brief Add startup phase.
+     *
+     * This shall be used before initialize.
+     *
+     * @param name          name of the phase
+     * @param dependencies  phases which shall be finished before this phase starts
+     *
+     * @return identifier of the phase
+     */
+    static PhaseId add_phase(const char* name, std::initializer_list<PhaseId> dependencies = {});
+
+    /**
+     * @brief Add initializer to startup phase.
+     *
+     * Initializers of the same phase may be executed in parallel.
+     * This shall be used before initialize.
+     *
+     * @param phase             identifier of the phase
+     * @param function_name     name of the initialized function
+     * @param initializer       callback which will be called once
+     */
+    static void add_initializer(PhaseId phase, const char* function_name, InitCallback initializer);
+
+    /**
+     * @brief Print time spent in each phase and each initializer.
+     *
+     * @param stream   output stream
+     */
+    static void print_startup_profile(std::ostream& stream);
+
+  private:
+    struct Phase
+    {
+        const char* name;
+        size_t level;
+    };
+
+    struct Initializer
+    {
+        PhaseId phase;
+        const char* function_name;
+        InitCallback callback;
+        uint64_t start_time_ns;
+        uint64_t end_time_ns;
+    };
+
+    struct Level
+    {
+        size_t begin;
+        size_t end;
+    };
+
+    static void barrier_wait();
+    static void run_level(size_t level);
+
   private:
     static pthread_barrier_t m_init_barrier;
     static InitCallback m_init_callback;
     static std::once_flag m_init_callback_flag;
+
+    static std::vector<Phase> m_phases;
+    static std::vector<Initializer> m_initializers;
+    static std::vector<size_t> m_initializer_order;
+    static std::vector<Level> m_levels;
+    static std::unique_ptr<std::atomic<size_t>[]> m_next_initializer;
+    static std::atomic<uint64_t> m_start_time_ns;
+    static uint64_t m_init_callback_start_time_ns;
+    static uint64_t m_init_callback_end_time_ns;
 };
 } // namespace taste
 
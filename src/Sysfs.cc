@@ -0,0 +1,83 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Sysfs.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace taste {
+bool
+Sysfs::read_line(const std::string& path, std::string& line)
+{
+    std::ifstream file(path);
+    return static_cast<bool>(std::getline(file, line));
+}
+
+bool
+Sysfs::parse_number(const std::string& text, int& value)
+{
+    const char* const begin = text.c_str();
+    char* end = nullptr;
+    errno = 0;
+    const long number = strtol(begin, &end, 10);
+    while(*end == ' ' || *end == '\n') {
+        ++end;
+    }
+    if(end == begin || *end != '\0' || errno != 0 || number < 0 || number > INT32_MAX) {
+        return false;
+    }
+    value = static_cast<int>(number);
+    return true;
+}
+
+std::vector<int>
+Sysfs::parse_cpu_list(const std::string& list)
+{
+    std::vector<int> cpus;
+    std::istringstream stream(list);
+    std::string range;
+    while(std::getline(stream, range, ',')) {
+        const size_t separator = range.find('-');
+        int first = 0;
+        int last = 0;
+        if(!parse_number(range.substr(0, separator), first)
+           || !parse_number(separator == std::string::npos ? range : range.substr(separator + 1), last)) {
+            continue;
+        }
+        for(int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+std::vector<int>
+Sysfs::read_cpu_list(const std::string& path)
+{
+    std::string line;
+    return read_line(path, line) ? parse_cpu_list(line) : std::vector<int>();
+}
+} // namespace taste
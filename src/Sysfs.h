@@ -0,0 +1,88 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_SYSFS_H
+#define TASTE_SYSFS_H
+
+/**
+ * @file    Sysfs.h
+ * @brief   Helpers reading host configuration from sysfs and procfs.
+ */
+
+#include <string>
+#include <vector>
+
+namespace taste {
+/**
+ * @brief Parsing of sysfs and procfs entries.
+ *
+ * Malformed entries are reported as missing or skipped, they never terminate the application.
+ */
+class Sysfs final
+{
+  public:
+    /**
+     * @brief Deleted default constructor.
+     */
+    Sysfs() = delete;
+
+    /**
+     * @brief Read the first line of a file
+     *
+     * @param path      path of the file
+     * @param line      read line
+     *
+     * @return true if the line was read, otherwise false
+     */
+    static bool read_line(const std::string& path, std::string& line);
+
+    /**
+     * @brief Parse non-negative decimal number, trailing whitespace is ignored
+     *
+     * @param text      text to parse
+     * @param value     parsed value, unchanged if the text is not such a number
+     *
+     * @return true if the text is a number, otherwise false
+     */
+    static bool parse_number(const std::string& text, int& value);
+
+    /**
+     * @brief Parse list of CPUs in the format used by sysfs, e.g. "0-3,8"
+     *
+     * @param list      list to parse, malformed ranges are skipped
+     *
+     * @return indices of listed CPUs
+     */
+    static std::vector<int> parse_cpu_list(const std::string& list);
+
+    /**
+     * @brief Read list of CPUs in the format used by sysfs
+     *
+     * @param path      path of the file
+     *
+     * @return indices of listed CPUs, empty if the file cannot be read
+     */
+    static std::vector<int> read_cpu_list(const std::string& path);
+};
+} // namespace taste
+
+#endif
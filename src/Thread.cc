@@ -22,23 +22,124 @@
 
 #include "Thread.h"
 
+#include "HugePageAllocator.h"
+#include "MemoryReport.h"
+#include "SingleThreaded.h"
+
+#include <cstring>
 #include <iostream>
 
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
 namespace taste {
-Thread::Thread(const int priority, const size_t stack_size)
+namespace {
+/**
+ * Maps a stack aligned to the given alignment, with an inaccessible guard page
+ * right below it, so an overflow faults instead of corrupting other memory.
+ * pthread does not add a guard page to stacks passed by pthread_attr_setstack.
+ */
+uint8_t*
+map_guarded_stack(size_t stack_size, size_t alignment)
+{
+    const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t reserved_size = page_size + alignment + stack_size;
+    void* memory = mmap(nullptr, reserved_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if(memory == MAP_FAILED) {
+        std::cerr << "Unable to allocate thread stack" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    uint8_t* const base = static_cast<uint8_t*>(memory);
+    const uintptr_t first_usable = reinterpret_cast<uintptr_t>(base) + page_size;
+    uint8_t* const stack = reinterpret_cast<uint8_t*>((first_usable + alignment - 1) / alignment * alignment);
+    uint8_t* const guard = stack - page_size;
+    if(mprotect(guard, page_size, PROT_NONE) != 0) {
+        std::cerr << "Unable to protect guard page of thread stack" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // the memory around the aligned stack is not needed
+    if(guard > base) {
+        munmap(base, static_cast<size_t>(guard - base));
+    }
+    uint8_t* const end = stack + stack_size;
+    if(end < base + reserved_size) {
+        munmap(end, static_cast<size_t>(base + reserved_size - end));
+    }
+    return stack;
+}
+
+/**
+ * Maps a stack of whole huge pages, from the reserved pool if available, otherwise
+ * advised to be backed by transparent huge pages. The address space is reserved first,
+ * so the guard page of normal size stays right below the stack as a separate mapping.
+ */
+uint8_t*
+map_huge_page_stack(size_t stack_size)
+{
+    const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t reserved_size = 2 * RT_HUGE_PAGE_SIZE + stack_size;
+    void* memory = mmap(nullptr, reserved_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if(memory == MAP_FAILED) {
+        std::cerr << "Unable to reserve thread stack" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    uint8_t* const base = static_cast<uint8_t*>(memory);
+    const uintptr_t first_usable = reinterpret_cast<uintptr_t>(base) + page_size;
+    uint8_t* const stack =
+            reinterpret_cast<uint8_t*>((first_usable + RT_HUGE_PAGE_SIZE - 1) / RT_HUGE_PAGE_SIZE * RT_HUGE_PAGE_SIZE);
+    const int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_STACK;
+    if(mmap(stack, stack_size, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0) == MAP_FAILED) {
+        if(mmap(stack, stack_size, PROT_READ | PROT_WRITE, flags, -1, 0) == MAP_FAILED) {
+            std::cerr << "Unable to allocate thread stack" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // failure is not fatal, the stack is backed by normal pages then
+        madvise(stack, stack_size, MADV_HUGEPAGE);
+    }
+
+    // the page below the stack keeps the inaccessible reservation, the rest is not needed
+    uint8_t* const guard = stack - page_size;
+    if(guard > base) {
+        munmap(base, static_cast<size_t>(guard - base));
+    }
+    uint8_t* const end = stack + stack_size;
+    if(end < base + reserved_size) {
+        munmap(end, static_cast<size_t>(base + reserved_size - end));
+    }
+    return stack;
+}
+} // namespace
+
+Thread::Thread(const int priority, const size_t stack_size, const char* name)
     : m_priority(priority)
     , m_stack_size(stack_size)
+    , m_cpu(-1)
+    , m_name(name)
+    , m_stack(nullptr)
+#ifdef RT_ENABLE_METRICS
+    , m_metrics(Metrics::register_thread(name, priority, stack_size))
+#endif
 {
 }
 
+void
+Thread::set_cpu(int cpu)
+{
+    m_cpu = cpu;
+}
+
 void
 Thread::start(void (*method)())
 {
     m_method = nullptr;
-    m_param = nullptr;
-    // the method is passed as an argument to method_wrapper
-    // the fields shall be set to nullptr.
-    create_thread(&Thread::method_wrapper, reinterpret_cast<void*>(method));
+    m_param = reinterpret_cast<void*>(method);
+    // the method is passed to method_wrapper using m_param field,
+    // therefore the parameter for method_wrapper is this
+    create_thread(&Thread::method_wrapper, reinterpret_cast<void*>(this));
 }
 
 void
@@ -62,6 +163,10 @@ Thread::join()
 void
 Thread::create_thread(void* (*fn)(void*), void* param)
 {
+    if(SingleThreaded::is_enabled()) {
+        SingleThreaded::register_thread();
+    }
+
     pthread_attr_t thread_attributes;
 
     int res = pthread_attr_init(&thread_attributes);
@@ -70,10 +175,28 @@ Thread::create_thread(void* (*fn)(void*), void* param)
         exit(EXIT_FAILURE);
     }
 
-    res = pthread_attr_setstacksize(&thread_attributes, m_stack_size);
-    if(res != 0) {
-        std::cerr << "Unable to set stack size in thread attributes" << std::endl;
-        exit(EXIT_FAILURE);
+    size_t stack_size = static_cast<size_t>(m_stack_size);
+    if(HugePageAllocator::is_enabled()) {
+        // huge pages back only whole aligned extents, so the stack spans whole huge pages
+        stack_size = (stack_size + RT_HUGE_PAGE_SIZE - 1) / RT_HUGE_PAGE_SIZE * RT_HUGE_PAGE_SIZE;
+        m_stack_size = static_cast<int>(stack_size);
+    }
+    if(HugePageAllocator::is_enabled() || MemoryReport::is_enabled()) {
+        m_stack = allocate_stack(stack_size);
+        if(MemoryReport::is_enabled()) {
+            MemoryReport::register_stack(m_name, m_stack, stack_size);
+        }
+        res = pthread_attr_setstack(&thread_attributes, m_stack, stack_size);
+        if(res != 0) {
+            std::cerr << "Unable to set stack in thread attributes" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        res = pthread_attr_setstacksize(&thread_attributes, stack_size);
+        if(res != 0) {
+            std::cerr << "Unable to set stack size in thread attributes" << std::endl;
+            exit(EXIT_FAILURE);
+        }
     }
 
     int policy = SCHED_FIFO;
@@ -100,6 +223,17 @@ Thread::create_thread(void* (*fn)(void*), void* param)
         exit(EXIT_FAILURE);
     }
 
+    if(m_cpu >= 0) {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(static_cast<size_t>(m_cpu), &cpu_set);
+        res = pthread_attr_setaffinity_np(&thread_attributes, sizeof(cpu_set), &cpu_set);
+        if(res != 0) {
+            std::cerr << "Unable to set CPU affinity in thread attributes" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
     res = pthread_create(&m_thread_id, &thread_attributes, fn, param);
     if(res != 0) {
         std::cerr << "Unable to create thread" << std::endl;
@@ -107,12 +241,42 @@ Thread::create_thread(void* (*fn)(void*), void* param)
     }
 
     pthread_attr_destroy(&thread_attributes);
+
+    MemoryReport::add(MemoryReport::Category::ThreadStacks, stack_size);
+}
+
+size_t
+Thread::stack_high_water_mark() const
+{
+    if(!MemoryReport::is_enabled() || m_stack == nullptr) {
+        return 0;
+    }
+    return MemoryReport::stack_high_water_mark(m_stack, static_cast<size_t>(m_stack_size));
+}
+
+uint8_t*
+Thread::allocate_stack(size_t stack_size)
+{
+    // the stack is never released, as runtime threads run until the program ends
+    if(HugePageAllocator::is_enabled()) {
+        // stacks are not packed with queue storage in the shared huge pages, so an overflow
+        // hits the guard page, the stack is prefaulted, so the thread does not fault on it
+        uint8_t* const stack = map_huge_page_stack(stack_size);
+        memset(stack, 0, stack_size);
+        return stack;
+    }
+
+    // the guard page is below the returned stack, so it is neither painted nor measured
+    return map_guarded_stack(stack_size, static_cast<size_t>(sysconf(_SC_PAGESIZE)));
 }
 
 void*
 Thread::method_wrapper(void* param)
 {
-    void (*method)() = reinterpret_cast<void (*)()>(param);
+    Thread* self = reinterpret_cast<Thread*>(param);
+    self->on_started();
+
+    void (*method)() = reinterpret_cast<void (*)()>(self->m_param);
     method();
 
     return nullptr;
@@ -122,6 +286,7 @@ void*
 Thread::method_wrapper_with_parameter(void* param)
 {
     Thread* self = reinterpret_cast<Thread*>(param);
+    self->on_started();
 
     void (*method)(void*) = self->m_method;
     method(self->m_param);
@@ -129,4 +294,22 @@ Thread::method_wrapper_with_parameter(void* param)
     return nullptr;
 }
 
+void
+Thread::on_started()
+{
+    if(m_name != nullptr) {
+        // names of threads are limited to 16 characters including terminating zero
+        char name[16];
+        strncpy(name, m_name, sizeof(name) - 1);
+        name[sizeof(name) - 1] = '\0';
+        pthread_setname_np(pthread_self(), name);
+    }
+
+#ifdef RT_ENABLE_METRICS
+    if(m_metrics != nullptr) {
+        m_metrics->thread_id.store(static_cast<int32_t>(syscall(SYS_gettid)), std::memory_order_relaxed);
+    }
+#endif
+}
+
 } // namespace taste
@@ -29,11 +29,24 @@
  */
 
 #include <cstddef>
+#include <cstdint>
 #include <pthread.h>
 
+#ifdef RT_ENABLE_METRICS
+#include "Metrics.h"
+#endif
+
 namespace taste {
 /**
  * @brief Thread implementation for TASTE
+ *
+ * If RT_USE_HUGE_PAGES is defined, the stack size is rounded up to whole
+ * RT_HUGE_PAGE_SIZE pages, as huge pages back only whole aligned extents.
+ * Each stack is a separate mapping from the reserved huge page pool, or
+ * advised to be backed by transparent huge pages if the pool is exhausted.
+ * It is prefaulted, with an inaccessible guard page of normal size below it.
+ * If RT_MEMORY_REPORT is defined, stacks are allocated by Thread and painted,
+ * so their peak usage can be measured, with a guard page below them as well.
  */
 class Thread final
 {
@@ -43,8 +56,9 @@ class Thread final
      *
      * @param priority     Priority of thread
      * @param stack_size   Stack size for new thread in bytes
+     * @param name         Name of thread, visible in system tools, may be nullptr
      */
-    Thread(const int priority, const size_t stack_size);
+    Thread(const int priority, const size_t stack_size, const char* name = nullptr);
 
     /// @brief deleted copy constructor
     Thread(const Thread&) = delete;
@@ -58,6 +72,15 @@ class Thread final
     /// @brief deleted move assignment operator
     Thread& operator=(Thread&&) = delete;
 
+    /**
+     * @brief Pin the thread to a single CPU
+     *
+     * This shall be used before the thread is started.
+     *
+     * @param cpu     Index of the CPU, or -1 to allow all CPUs
+     */
+    void set_cpu(int cpu);
+
     /**
      * @brief Starts a thread
      *
@@ -76,18 +99,33 @@ class Thread final
     /// @brief Waits for the thread to finish
     void join();
 
+    /**
+     * @brief Get the peak usage of the thread stack
+     *
+     * @return peak stack usage in bytes, or 0 if RT_MEMORY_REPORT is not defined
+     */
+    size_t stack_high_water_mark() const;
+
   private:
     void create_thread(void* (*fn)(void*), void* param);
+    static uint8_t* allocate_stack(size_t stack_size);
     static void* method_wrapper(void* param);
     static void* method_wrapper_with_parameter(void* param);
+    void on_started();
 
   private:
     int m_priority;
     int m_stack_size;
+    int m_cpu;
+    const char* m_name;
+    uint8_t* m_stack;
     pthread_t m_thread_id;
 
     void (*m_method)(void*);
     void* m_param;
+#ifdef RT_ENABLE_METRICS
+    ThreadMetrics* const m_metrics;
+#endif
 };
 } // namespace taste
 
@@ -22,11 +22,21 @@
 
 #include "Timer.h"
 
+#include "Clock.h"
+
 namespace taste {
 void
 Timer::initialize()
 {
-    m_global_start_time = std::chrono::steady_clock::now();
+    // Timer shares the epoch with Hal, steady_clock is backed by CLOCK_MONOTONIC
+    Clock::initialize();
+    m_global_start_time = std::chrono::steady_clock::time_point(std::chrono::nanoseconds(Clock::epoch_ns()));
+}
+
+std::chrono::steady_clock::time_point
+Timer::global_start_time()
+{
+    return m_global_start_time;
 }
 
 std::chrono::steady_clock::time_point Timer::m_global_start_time = {};
@@ -31,9 +31,24 @@
 #include <chrono>
 #include <thread>
 
+#ifdef RT_ENABLE_METRICS
+#include "Metrics.h"
+#endif
+
+#ifdef RT_SINGLE_THREADED
+#include "Clock.h"
+#endif
+
+#ifdef RT_EXECUTION_PROFILING
+#include "ExecutionStatistics.h"
+#endif
+
 namespace taste {
 /**
  * @brief Times is used to implement cyclic interfaces in TASTE
+ *
+ * If RT_EXECUTION_PROFILING is defined, execution of each activation
+ * is measured using ExecutionStatistics, with the deadline equal to the period.
  */
 class Timer final
 {
@@ -51,6 +66,21 @@ class Timer final
                     const std::chrono::milliseconds interval,
                     T callback);
 
+    /**
+     * @brief Execute given operation with given interval.
+     *
+     * @tparam T                callback type
+     * @param name              name of the cyclic interface, used in metrics and statistics
+     * @param dispatch_offset   dispatch offset value
+     * @param interval          period value
+     * @param callback          function like object to execute
+     */
+    template<typename T>
+    static void run(const char* name,
+                    const std::chrono::milliseconds dispatch_offset,
+                    const std::chrono::milliseconds interval,
+                    T callback);
+
     /**
      * @brief Initialize Timer
      *
@@ -60,6 +90,13 @@ class Timer final
      */
     static void initialize();
 
+    /**
+     * @brief Get the start time used by all cyclic interfaces
+     *
+     * @return start time set by initialize
+     */
+    static std::chrono::steady_clock::time_point global_start_time();
+
   private:
     static std::chrono::steady_clock::time_point m_global_start_time;
 };
@@ -68,11 +105,55 @@ template<typename T>
 void
 Timer::run(const std::chrono::milliseconds dispatch_offset, const std::chrono::milliseconds period, T callback)
 {
+    run(nullptr, dispatch_offset, period, callback);
+}
+
+template<typename T>
+void
+Timer::run(const char* name,
+           const std::chrono::milliseconds dispatch_offset,
+           const std::chrono::milliseconds period,
+           T callback)
+{
+#ifdef RT_ENABLE_METRICS
+    TimerMetrics* const metrics = Metrics::register_timer(
+            name, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(period).count()));
+#endif
+#ifdef RT_EXECUTION_PROFILING
+    ExecutionStatistics statistics(
+            name, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(period).count()));
+#endif
+
     auto wakeup_time = m_global_start_time + dispatch_offset;
     while(true) {
+#ifdef RT_SINGLE_THREADED
+        // there is no clock maintenance thread, see Clock
+        Clock::synchronize();
+#endif
         std::this_thread::sleep_until(wakeup_time);
+#ifdef RT_ENABLE_METRICS
+        if(metrics != nullptr) {
+            const auto lateness = std::chrono::steady_clock::now() - wakeup_time;
+            Metrics::add(metrics->activations);
+            Metrics::update_maximum(metrics->max_lateness_ns,
+                                    static_cast<uint64_t>(
+                                            std::chrono::duration_cast<std::chrono::nanoseconds>(lateness).count()));
+        }
+#endif
+#ifdef RT_EXECUTION_PROFILING
+        const ExecutionStatistics::Activation activation = ExecutionStatistics::start(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(wakeup_time.time_since_epoch()).count()));
+#endif
         callback();
+#ifdef RT_EXECUTION_PROFILING
+        statistics.finish(activation);
+#endif
         wakeup_time = wakeup_time + period;
+#ifdef RT_ENABLE_METRICS
+        if(metrics != nullptr && std::chrono::steady_clock::now() > wakeup_time) {
+            Metrics::add(metrics->overruns);
+        }
+#endif
     }
 }
 
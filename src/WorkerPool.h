@@ -0,0 +1,280 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_WORKER_POOL_H
+#define TASTE_WORKER_POOL_H
+
+/**
+ * @file    WorkerPool.h
+ * @brief   Pool of threads serving a single message queue.
+ */
+
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+#include "Queue.h"
+#include "Request.h"
+#include "Thread.h"
+
+#ifdef RT_EXECUTION_PROFILING
+#include "ExecutionStatistics.h"
+#endif
+
+#ifdef RT_SINGLE_THREADED
+#error "WorkerPool requires multiple threads and cannot be used in single-threaded build"
+#endif
+
+#ifndef RT_WORKER_POOL_MAX_SENDERS
+#define RT_WORKER_POOL_MAX_SENDERS 64
+#endif
+
+namespace taste {
+/**
+ * @brief Pool of worker threads serving a queue of a stateless function.
+ *
+ * Requests from the queue are processed by multiple threads in parallel,
+ * so it shall be used only for functions without state shared between
+ * requests. The handler is called concurrently from all workers.
+ *
+ * With Ordering::PerSender, requests from the same sender are processed
+ * one at a time in the order of arrival, while requests from different
+ * senders are processed in parallel. Each request receives a ticket of its
+ * sender when it is taken from the queue, and the worker waits until
+ * previous tickets of the sender are processed. Senders are distinguished
+ * modulo RT_WORKER_POOL_MAX_SENDERS, senders sharing a slot are ordered
+ * together.
+ *
+ * If RT_EXECUTION_PROFILING is defined, execution of the handler is measured
+ * using ExecutionStatistics, from the moment the request is taken from queue.
+ *
+ * @tparam PARAMETER_SIZE The maximum size of single request in bytes.
+ */
+template<size_t PARAMETER_SIZE>
+class WorkerPool final
+{
+  public:
+    /**
+     * @brief Ordering guarantees of request processing
+     */
+    enum class Ordering
+    {
+        /// Requests are processed in any order
+        None,
+        /// Requests from the same sender are processed in order
+        PerSender
+    };
+
+    /**
+     * @brief Type definition of request handler function
+     */
+    using Handler = void (*)(const Request<PARAMETER_SIZE>& request);
+
+    /**
+     * @brief Constructor
+     *
+     * @param queue           Queue served by the pool
+     * @param worker_count    Number of worker threads
+     * @param priority        Priority of worker threads
+     * @param stack_size      Stack size of worker threads in bytes
+     * @param ordering        Ordering guarantees
+     * @param handler         Function called for each request
+     * @param name            Name of worker threads, may be nullptr
+     */
+    WorkerPool(Queue<PARAMETER_SIZE>& queue,
+               size_t worker_count,
+               int priority,
+               size_t stack_size,
+               Ordering ordering,
+               Handler handler,
+               const char* name = nullptr);
+
+    /// @brief deleted copy constructor
+    WorkerPool(const WorkerPool&) = delete;
+
+    /// @brief deleted move constructor
+    WorkerPool(WorkerPool&&) = delete;
+
+    /// @brief deleted copy assignment operator
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /// @brief deleted move assignment operator
+    WorkerPool& operator=(WorkerPool&&) = delete;
+
+    /**
+     * @brief Start worker threads
+     *
+     * Workers run until the program ends.
+     */
+    void start();
+
+  private:
+    static void worker(void* param);
+    void handle(const Request<PARAMETER_SIZE>& request, uint64_t release_time_ns = 0);
+    void take(Request<PARAMETER_SIZE>& request, uint64_t& ticket);
+    void wait_for_turn(size_t sender, uint64_t ticket);
+    void finish_turn(size_t sender);
+    static size_t sender_slot(asn1SccPID sender_pid);
+
+  private:
+    Queue<PARAMETER_SIZE>& m_queue;
+    const size_t m_worker_count;
+    const Ordering m_ordering;
+    const Handler m_handler;
+    std::unique_ptr<std::unique_ptr<Thread>[]> m_workers;
+
+    /// Serializes taking requests with assignment of tickets
+    std::mutex m_take_mutex;
+    uint64_t m_next_ticket[RT_WORKER_POOL_MAX_SENDERS];
+
+    std::mutex m_order_mutex;
+    std::condition_variable m_order_condition_variable;
+    uint64_t m_serving_ticket[RT_WORKER_POOL_MAX_SENDERS];
+
+#ifdef RT_EXECUTION_PROFILING
+    ExecutionStatistics m_statistics;
+#endif
+};
+
+template<size_t PARAMETER_SIZE>
+WorkerPool<PARAMETER_SIZE>::WorkerPool(Queue<PARAMETER_SIZE>& queue,
+                                       size_t worker_count,
+                                       int priority,
+                                       size_t stack_size,
+                                       Ordering ordering,
+                                       Handler handler,
+                                       const char* name)
+    : m_queue(queue)
+    , m_worker_count(worker_count)
+    , m_ordering(ordering)
+    , m_handler(handler)
+    , m_workers(new std::unique_ptr<Thread>[worker_count])
+    , m_next_ticket()
+    , m_serving_ticket()
+#ifdef RT_EXECUTION_PROFILING
+    , m_statistics(name)
+#endif
+{
+    if(worker_count == 0) {
+        std::cerr << "Worker pool shall have at least one worker" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    for(size_t i = 0; i < worker_count; ++i) {
+        m_workers[i].reset(new Thread(priority, stack_size, name));
+    }
+}
+
+template<size_t PARAMETER_SIZE>
+void
+WorkerPool<PARAMETER_SIZE>::start()
+{
+    for(size_t i = 0; i < m_worker_count; ++i) {
+        m_workers[i]->start(&WorkerPool::worker, this);
+    }
+}
+
+template<size_t PARAMETER_SIZE>
+void
+WorkerPool<PARAMETER_SIZE>::worker(void* param)
+{
+    WorkerPool& pool = *static_cast<WorkerPool*>(param);
+    Request<PARAMETER_SIZE> request;
+
+    while(true) {
+        if(pool.m_ordering == Ordering::None) {
+            pool.m_queue.get(request);
+            pool.handle(request);
+        } else {
+            uint64_t ticket;
+            pool.take(request, ticket);
+#ifdef RT_EXECUTION_PROFILING
+            const ExecutionStatistics::Activation activation = ExecutionStatistics::start();
+#endif
+            const size_t sender = sender_slot(request.sender_pid());
+            pool.wait_for_turn(sender, ticket);
+#ifdef RT_EXECUTION_PROFILING
+            pool.handle(request, activation.release_time_ns);
+#else
+            pool.handle(request);
+#endif
+            pool.finish_turn(sender);
+        }
+    }
+}
+
+template<size_t PARAMETER_SIZE>
+void
+WorkerPool<PARAMETER_SIZE>::handle(const Request<PARAMETER_SIZE>& request, uint64_t release_time_ns)
+{
+#ifdef RT_EXECUTION_PROFILING
+    const ExecutionStatistics::Scope scope(m_statistics, release_time_ns);
+#else
+    (void)release_time_ns;
+#endif
+    m_handler(request);
+}
+
+template<size_t PARAMETER_SIZE>
+void
+WorkerPool<PARAMETER_SIZE>::take(Request<PARAMETER_SIZE>& request, uint64_t& ticket)
+{
+    // only one worker waits inside the queue, others wait for the mutex
+    std::lock_guard<std::mutex> lock(m_take_mutex);
+    m_queue.get(request);
+    ticket = m_next_ticket[sender_slot(request.sender_pid())]++;
+}
+
+template<size_t PARAMETER_SIZE>
+void
+WorkerPool<PARAMETER_SIZE>::wait_for_turn(size_t sender, uint64_t ticket)
+{
+    std::unique_lock<std::mutex> lock(m_order_mutex);
+    while(m_serving_ticket[sender] != ticket) {
+        m_order_condition_variable.wait(lock);
+    }
+}
+
+template<size_t PARAMETER_SIZE>
+void
+WorkerPool<PARAMETER_SIZE>::finish_turn(size_t sender)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_order_mutex);
+        ++m_serving_ticket[sender];
+    }
+    // workers of different senders share the condition variable
+    m_order_condition_variable.notify_all();
+}
+
+template<size_t PARAMETER_SIZE>
+size_t
+WorkerPool<PARAMETER_SIZE>::sender_slot(asn1SccPID sender_pid)
+{
+    return static_cast<size_t>(sender_pid) % RT_WORKER_POOL_MAX_SENDERS;
+}
+
+} // namespace taste
+
+#endif
@@ -0,0 +1,382 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    LoadGenerator.cc
+ * @brief   Synthetic TASTE system load generator.
+ *
+ * Usage: taste-load <topology> [duration_s=10] [drain_ms=500] [scale=1] [noise=0] [noise_duty=50]
+ *                  [noise_priority=1] [noise_cpu=<all>]
+ *
+ * The system described by the topology is instantiated using runtime primitives
+ * and executed for the given duration. Afterwards the cyclic interfaces stop
+ * sending messages, the queues are drained and the end-to-end response times
+ * and message loss are reported. The response times are collected in fixed-size
+ * histograms, so recording never allocates.
+ *
+ * Noise threads run at the given FIFO priority, optionally pinned to a single CPU,
+ * and busy-loop for the duty percentage of every 10 ms period.
+ *
+ * Before the start, the response-time analysis of the topology is printed.
+ */
+
+#include "Topology.h"
+
+#include "Clock.h"
+#ifdef RT_ALLOCATION_TRACKER
+#include "AllocationTracker.h"
+#endif
+#include "ExecutionStatistics.h"
+#include "Lock.h"
+#include "Queue.h"
+#include "SchedulabilityAnalysis.h"
+#include "StartBarrier.h"
+#include "Thread.h"
+#include "Timer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace taste {
+namespace load_generator {
+namespace {
+constexpr size_t MAX_PAYLOAD_SIZE = 4096;
+constexpr size_t NOISE_STACK_SIZE = 65536;
+constexpr uint64_t ALL_CPUS = UINT64_MAX;
+
+using LoadQueue = Queue<MAX_PAYLOAD_SIZE>;
+using LoadRequest = Request<MAX_PAYLOAD_SIZE>;
+
+struct Function
+{
+    const FunctionDescription* description;
+    std::unique_ptr<LoadQueue> queue;
+    std::unique_ptr<Lock> lock;
+    std::unique_ptr<Thread> thread;
+    std::vector<const SporadicDescription*> outgoing;
+    ExecutionStatistics::Histogram latency_histogram;
+    uint64_t latency_count;
+    uint64_t max_latency_ns;
+};
+
+struct Cyclic
+{
+    const CyclicDescription* description;
+    std::unique_ptr<Thread> thread;
+    size_t burst;
+};
+
+std::vector<Function> functions;
+std::vector<Cyclic> cyclic_interfaces;
+std::vector<std::unique_ptr<Thread>> noise_threads;
+unsigned int noise_duty_percent;
+std::atomic<bool> running(true);
+std::atomic<uint64_t> sent_messages(0);
+std::atomic<uint64_t> received_messages(0);
+
+void
+busy_work(uint64_t work_ns)
+{
+    const uint64_t end_time = Clock::now_ns() + work_ns;
+    while(Clock::now_ns() < end_time) {
+    }
+}
+
+void
+send(size_t target, size_t payload_size, uint64_t origin_time)
+{
+    uint8_t payload[MAX_PAYLOAD_SIZE] = {};
+    memcpy(payload, &origin_time, sizeof(origin_time));
+    sent_messages.fetch_add(1, std::memory_order_relaxed);
+    functions[target].queue->put(PID_env, payload, payload_size);
+}
+
+void
+function_thread(void* param)
+{
+    Function& function = *static_cast<Function*>(param);
+    std::unique_ptr<LoadRequest> request(new LoadRequest());
+
+    StartBarrier::wait();
+    while(true) {
+        function.queue->get(*request);
+        received_messages.fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t origin_time;
+        memcpy(&origin_time, request->data(), sizeof(origin_time));
+
+        function.lock->lock();
+        busy_work(function.description->work_ns);
+        if(function.outgoing.empty()) {
+            const uint64_t latency = Clock::now_ns() - origin_time;
+            ++function.latency_histogram[ExecutionStatistics::bucket_of(latency)];
+            ++function.latency_count;
+            function.max_latency_ns = std::max(function.max_latency_ns, latency);
+        }
+        for(const SporadicDescription* sporadic : function.outgoing) {
+            send(sporadic->target, sporadic->payload_size, origin_time);
+        }
+        function.lock->unlock();
+    }
+}
+
+void
+cyclic_thread(void* param)
+{
+    Cyclic& cyclic = *static_cast<Cyclic*>(param);
+    const CyclicDescription& description = *cyclic.description;
+    Function& function = functions[description.function];
+
+    StartBarrier::wait();
+    Timer::run(description.name.c_str(),
+               std::chrono::milliseconds(description.offset_ms),
+               std::chrono::milliseconds(description.period_ms),
+               [&cyclic, &description, &function]() {
+                   if(!running.load(std::memory_order_relaxed)) {
+                       return;
+                   }
+                   function.lock->lock();
+                   busy_work(function.description->work_ns);
+                   if(description.target != NO_TARGET) {
+                       for(size_t i = 0; i < cyclic.burst; ++i) {
+                           send(description.target, description.payload_size, Clock::now_ns());
+                       }
+                   }
+                   function.lock->unlock();
+               });
+}
+
+void
+noise_thread()
+{
+    constexpr uint64_t NOISE_PERIOD_NS = 10000000;
+    const uint64_t busy_time = NOISE_PERIOD_NS * noise_duty_percent / 100;
+    while(true) {
+        busy_work(busy_time);
+        std::this_thread::sleep_for(std::chrono::nanoseconds(NOISE_PERIOD_NS - busy_time));
+    }
+}
+
+double
+percentile_us(const Function& function, double fraction)
+{
+    constexpr double NANOSECONDS_IN_MICROSECOND = 1000.0;
+    // buckets are wider than the exact maximum
+    const uint64_t value = ExecutionStatistics::percentile(function.latency_histogram, fraction);
+    return static_cast<double>(std::min(value, function.max_latency_ns)) / NANOSECONDS_IN_MICROSECOND;
+}
+
+void
+print_report(const Topology& topology, uint64_t duration_ns)
+{
+    constexpr double NANOSECONDS_IN_MICROSECOND = 1000.0;
+    constexpr double NANOSECONDS_IN_SECOND = 1e9;
+
+    std::cout << "End-to-end response times [us]:" << std::endl;
+    for(const Function& function : functions) {
+        if(function.latency_count == 0) {
+            continue;
+        }
+        std::cout << "  " << function.description->name << ": " << function.latency_count << " messages"
+                  << ", p50 " << percentile_us(function, 0.5) << ", p90 " << percentile_us(function, 0.9)
+                  << ", p99 " << percentile_us(function, 0.99) << ", p99.9 " << percentile_us(function, 0.999)
+                  << ", max " << static_cast<double>(function.max_latency_ns) / NANOSECONDS_IN_MICROSECOND
+                  << std::endl;
+    }
+
+    const uint64_t sent = sent_messages.load();
+    const uint64_t received = received_messages.load();
+    const uint64_t lost = sent > received ? sent - received : 0;
+    std::cout << "Messages: sent " << sent << ", received " << received << ", lost " << lost << " ("
+              << (sent == 0 ? 0.0 : 100.0 * static_cast<double>(lost) / static_cast<double>(sent)) << "%)"
+              << std::endl;
+    const double throughput = static_cast<double>(received) * NANOSECONDS_IN_SECOND / static_cast<double>(duration_ns);
+    std::cout << "Throughput: " << throughput << " messages/s with " << topology.functions.size() << " functions, "
+              << topology.cyclic_interfaces.size() << " cyclic and " << topology.sporadic_interfaces.size()
+              << " sporadic interfaces" << std::endl;
+}
+
+void
+analyze_schedulability(const Topology& topology, uint64_t scale)
+{
+    constexpr double NANOSECONDS_IN_SECOND = 1e9;
+    constexpr uint64_t NANOSECONDS_IN_MILLISECOND = 1000000;
+    constexpr int HIGHEST_PRIORITY = 99;
+    constexpr int LOWEST_PRIORITY = 1;
+
+    SchedulabilityAnalysis analysis;
+    std::vector<double> message_rates(topology.functions.size(), 0.0);
+    for(const CyclicDescription& cyclic : topology.cyclic_interfaces) {
+        const FunctionDescription& function = topology.functions[cyclic.function];
+        analysis.add_cyclic(cyclic.name.c_str(),
+                            function.priority,
+                            cyclic.period_ms * NANOSECONDS_IN_MILLISECOND,
+                            function.work_ns);
+    }
+    // each processed message is forwarded through all sporadic interfaces of the function,
+    // rates of an acyclic topology are final after the number of functions passes
+    for(size_t pass = 0; pass < topology.functions.size(); ++pass) {
+        std::vector<double> rates(topology.functions.size(), 0.0);
+        for(const CyclicDescription& cyclic : topology.cyclic_interfaces) {
+            if(cyclic.target != NO_TARGET) {
+                rates[cyclic.target] += static_cast<double>(cyclic.burst * scale) * NANOSECONDS_IN_SECOND
+                                        / static_cast<double>(cyclic.period_ms * NANOSECONDS_IN_MILLISECOND);
+            }
+        }
+        for(const SporadicDescription& sporadic : topology.sporadic_interfaces) {
+            rates[sporadic.target] += message_rates[sporadic.source];
+        }
+        message_rates = rates;
+    }
+    // messages are modelled by their average rate, bursts are not bounded by the topology
+    for(size_t i = 0; i < topology.functions.size(); ++i) {
+        if(message_rates[i] > 0.0) {
+            const FunctionDescription& function = topology.functions[i];
+            analysis.add_sporadic(function.name.c_str(),
+                                  function.priority,
+                                  static_cast<uint64_t>(NANOSECONDS_IN_SECOND / message_rates[i]),
+                                  function.work_ns);
+        }
+    }
+
+    analysis.analyze();
+    analysis.suggest_priorities(HIGHEST_PRIORITY, LOWEST_PRIORITY);
+    analysis.print_report(std::cout);
+}
+
+std::map<std::string, uint64_t>
+parse_options(int argc, char* argv[])
+{
+    std::map<std::string, uint64_t> options = {
+        { "duration_s", 10 }, { "drain_ms", 500 }, { "scale", 1 }, { "noise", 0 },
+        { "noise_duty", 50 }, { "noise_priority", 1 }, { "noise_cpu", ALL_CPUS }
+    };
+    for(int i = 2; i < argc; ++i) {
+        const std::string argument = argv[i];
+        const size_t separator = argument.find('=');
+        if(separator == std::string::npos || options.count(argument.substr(0, separator)) == 0) {
+            std::cerr << "Unknown option '" << argument << "'" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        options[argument.substr(0, separator)] = strtoull(argument.c_str() + separator + 1, nullptr, 10);
+    }
+    return options;
+}
+} // namespace
+} // namespace load_generator
+} // namespace taste
+
+int
+main(int argc, char* argv[])
+{
+    using namespace taste;
+    using namespace taste::load_generator;
+
+    if(argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <topology> [duration_s=10] [drain_ms=500] [scale=1] [noise=0] [noise_duty=50]"
+                  << " [noise_priority=1] [noise_cpu=<all>]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::ifstream topology_file(argv[1]);
+    if(!topology_file) {
+        std::cerr << "Unable to open topology file '" << argv[1] << "'" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const Topology topology = Topology::parse(topology_file, MAX_PAYLOAD_SIZE);
+    std::map<std::string, uint64_t> options = parse_options(argc, argv);
+    analyze_schedulability(topology, options["scale"]);
+
+    functions.resize(topology.functions.size());
+    for(size_t i = 0; i < functions.size(); ++i) {
+        const FunctionDescription& description = topology.functions[i];
+        functions[i].description = &description;
+        functions[i].queue.reset(new LoadQueue(description.queue_size, description.name.c_str()));
+        functions[i].lock.reset(new Lock(description.name.c_str()));
+        functions[i].thread.reset(new Thread(description.priority, description.stack_size, description.name.c_str()));
+        functions[i].latency_histogram = {};
+        functions[i].latency_count = 0;
+        functions[i].max_latency_ns = 0;
+    }
+    for(const SporadicDescription& sporadic : topology.sporadic_interfaces) {
+        functions[sporadic.source].outgoing.push_back(&sporadic);
+    }
+    cyclic_interfaces.resize(topology.cyclic_interfaces.size());
+    for(size_t i = 0; i < cyclic_interfaces.size(); ++i) {
+        const CyclicDescription& description = topology.cyclic_interfaces[i];
+        const FunctionDescription& function = topology.functions[description.function];
+        cyclic_interfaces[i].description = &description;
+        cyclic_interfaces[i].burst = description.burst * options["scale"];
+        cyclic_interfaces[i].thread.reset(new Thread(function.priority, function.stack_size, description.name.c_str()));
+    }
+
+    noise_duty_percent = static_cast<unsigned int>(std::min<uint64_t>(options["noise_duty"], 100));
+    for(uint64_t i = 0; i < options["noise"]; ++i) {
+        noise_threads.emplace_back(
+            new Thread(static_cast<int>(options["noise_priority"]), NOISE_STACK_SIZE, "noise"));
+        if(options["noise_cpu"] != ALL_CPUS) {
+            noise_threads.back()->set_cpu(static_cast<int>(options["noise_cpu"]));
+        }
+        noise_threads.back()->start(noise_thread);
+    }
+
+    Timer::initialize();
+    StartBarrier::initialize(functions.size() + cyclic_interfaces.size() + 1, []() {});
+    for(Function& function : functions) {
+        function.thread->start(function_thread, &function);
+    }
+    for(Cyclic& cyclic : cyclic_interfaces) {
+        cyclic.thread->start(cyclic_thread, &cyclic);
+    }
+    StartBarrier::wait();
+
+    const uint64_t start_time = Clock::now_ns();
+    std::this_thread::sleep_for(std::chrono::seconds(options["duration_s"]));
+    running = false;
+    const uint64_t duration = Clock::now_ns() - start_time;
+    std::this_thread::sleep_for(std::chrono::milliseconds(options["drain_ms"]));
+#ifdef RT_ALLOCATION_TRACKER
+    // the report allocates, only the measured run is tracked
+    AllocationTracker::disarm();
+    std::cout << "Memory allocations after startup: " << AllocationTracker::allocation_count() << std::endl;
+#endif
+
+    // function threads are still running, their locks protect the latency samples
+    for(Function& function : functions) {
+        function.lock->lock();
+    }
+    print_report(topology, duration);
+#ifdef RT_EXECUTION_PROFILING
+    ExecutionStatistics::print_all(std::cout);
+#endif
+    std::cout.flush();
+
+    // runtime threads never return, static objects are not destroyed
+    std::quick_exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,180 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Topology.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+namespace taste {
+namespace load_generator {
+namespace {
+constexpr int DEFAULT_PRIORITY = 1;
+constexpr size_t DEFAULT_STACK_SIZE = 65536;
+constexpr size_t DEFAULT_QUEUE_SIZE = 64;
+constexpr size_t DEFAULT_PAYLOAD_SIZE = 16;
+constexpr uint64_t NANOSECONDS_IN_MICROSECOND = 1000;
+
+class Line final
+{
+  public:
+    Line(size_t number, std::istringstream& stream)
+        : m_number(number)
+    {
+        std::string token;
+        while(stream >> token) {
+            const size_t separator = token.find('=');
+            if(separator == std::string::npos) {
+                error("expected key=value, got '" + token + "'");
+            }
+            m_values[token.substr(0, separator)] = token.substr(separator + 1);
+        }
+    }
+
+    [[noreturn]] void error(const std::string& message) const
+    {
+        std::cerr << "Topology line " << m_number << ": " << message << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    bool has(const std::string& key) const { return m_values.count(key) != 0; }
+
+    const std::string& text(const std::string& key) const
+    {
+        const auto it = m_values.find(key);
+        if(it == m_values.end()) {
+            error("missing '" + key + "'");
+        }
+        return it->second;
+    }
+
+    uint64_t number(const std::string& key, uint64_t default_value) const
+    {
+        if(!has(key)) {
+            return default_value;
+        }
+        char* end = nullptr;
+        const unsigned long long value = strtoull(text(key).c_str(), &end, 10);
+        if(end == nullptr || *end != '\0') {
+            error("invalid number in '" + key + "'");
+        }
+        return value;
+    }
+
+    size_t function(const std::vector<FunctionDescription>& functions, const std::string& key) const
+    {
+        const std::string& name = text(key);
+        for(size_t i = 0; i < functions.size(); ++i) {
+            if(functions[i].name == name) {
+                return i;
+            }
+        }
+        error("unknown function '" + name + "'");
+    }
+
+  private:
+    size_t m_number;
+    std::map<std::string, std::string> m_values;
+};
+
+size_t
+payload_size(const Line& line, size_t max_payload_size)
+{
+    const size_t size = line.number("payload", DEFAULT_PAYLOAD_SIZE);
+    if(size < sizeof(uint64_t) || size > max_payload_size) {
+        line.error("payload shall be between " + std::to_string(sizeof(uint64_t)) + " and "
+                   + std::to_string(max_payload_size));
+    }
+    return size;
+}
+} // namespace
+
+Topology
+Topology::parse(std::istream& stream, size_t max_payload_size)
+{
+    Topology topology;
+    std::string text;
+    size_t line_number = 0;
+
+    while(std::getline(stream, text)) {
+        ++line_number;
+        const size_t comment = text.find('#');
+        if(comment != std::string::npos) {
+            text.erase(comment);
+        }
+
+        std::istringstream tokens(text);
+        std::string kind;
+        std::string name;
+        if(!(tokens >> kind)) {
+            continue;
+        }
+        if(!(tokens >> name)) {
+            std::cerr << "Topology line " << line_number << ": missing name" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        const Line line(line_number, tokens);
+
+        if(kind == "function") {
+            FunctionDescription function;
+            function.name = name;
+            function.priority = static_cast<int>(line.number("priority", DEFAULT_PRIORITY));
+            function.stack_size = line.number("stack", DEFAULT_STACK_SIZE);
+            function.queue_size = line.number("queue", DEFAULT_QUEUE_SIZE);
+            function.work_ns = line.number("work_us", 0) * NANOSECONDS_IN_MICROSECOND;
+            topology.functions.push_back(function);
+        } else if(kind == "cyclic") {
+            CyclicDescription cyclic;
+            cyclic.name = name;
+            cyclic.function = line.function(topology.functions, "function");
+            cyclic.period_ms = line.number("period_ms", 0);
+            if(cyclic.period_ms == 0) {
+                line.error("period_ms shall be greater than 0");
+            }
+            cyclic.offset_ms = line.number("offset_ms", 0);
+            cyclic.burst = line.number("burst", 1);
+            cyclic.target = line.has("to") ? line.function(topology.functions, "to") : NO_TARGET;
+            cyclic.payload_size = payload_size(line, max_payload_size);
+            topology.cyclic_interfaces.push_back(cyclic);
+        } else if(kind == "sporadic") {
+            SporadicDescription sporadic;
+            sporadic.name = name;
+            sporadic.source = line.function(topology.functions, "from");
+            sporadic.target = line.function(topology.functions, "to");
+            sporadic.payload_size = payload_size(line, max_payload_size);
+            topology.sporadic_interfaces.push_back(sporadic);
+        } else {
+            line.error("unknown entity '" + kind + "'");
+        }
+    }
+
+    if(topology.functions.empty()) {
+        std::cerr << "Topology does not contain any function" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    return topology;
+}
+} // namespace load_generator
+} // namespace taste
@@ -0,0 +1,125 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASTE_LOAD_GENERATOR_TOPOLOGY_H
+#define TASTE_LOAD_GENERATOR_TOPOLOGY_H
+
+/**
+ * @file    Topology.h
+ * @brief   Description of synthetic TASTE system.
+ *
+ * Topology is described by text, one entity per line, '#' starts a comment:
+ *
+ *     function <name> [priority=<p>] [stack=<bytes>] [queue=<elements>] [work_us=<us>]
+ *     cyclic <name> function=<f> period_ms=<ms> [offset_ms=<ms>] [burst=<n>] [to=<g>] [payload=<bytes>]
+ *     sporadic <name> from=<f> to=<g> [payload=<bytes>]
+ *
+ * A cyclic interface of function f is activated every period and sends burst
+ * messages to function g. Every message received by function f is forwarded
+ * through all sporadic interfaces from f. A function without outgoing sporadic
+ * interfaces is a sink, which measures end-to-end response time.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace taste {
+namespace load_generator {
+/// Value used when cyclic interface does not send messages
+constexpr size_t NO_TARGET = static_cast<size_t>(-1);
+
+/// Description of function
+struct FunctionDescription
+{
+    /// Name of the function
+    std::string name;
+    /// Priority of the function threads
+    int priority;
+    /// Stack size of the function threads
+    size_t stack_size;
+    /// Capacity of the function queue
+    size_t queue_size;
+    /// Busy CPU time consumed by each activation
+    uint64_t work_ns;
+};
+
+/// Description of cyclic interface
+struct CyclicDescription
+{
+    /// Name of the interface
+    std::string name;
+    /// Index of the function providing the interface
+    size_t function;
+    /// Period of the interface
+    uint64_t period_ms;
+    /// Dispatch offset of the interface
+    uint64_t offset_ms;
+    /// Number of messages sent in each activation
+    size_t burst;
+    /// Index of the function receiving messages, or NO_TARGET
+    size_t target;
+    /// Size of sent messages
+    size_t payload_size;
+};
+
+/// Description of sporadic interface
+struct SporadicDescription
+{
+    /// Name of the interface
+    std::string name;
+    /// Index of the function calling the interface
+    size_t source;
+    /// Index of the function providing the interface
+    size_t target;
+    /// Size of sent messages
+    size_t payload_size;
+};
+
+/// Description of synthetic system
+struct Topology
+{
+    /// Functions
+    std::vector<FunctionDescription> functions;
+    /// Cyclic interfaces
+    std::vector<CyclicDescription> cyclic_interfaces;
+    /// Sporadic interfaces
+    std::vector<SporadicDescription> sporadic_interfaces;
+
+    /**
+     * @brief Parse topology description.
+     *
+     * Errors are reported and terminate the program.
+     *
+     * @param stream            input stream
+     * @param max_payload_size  maximum size of message
+     *
+     * @return parsed topology
+     */
+    static Topology parse(std::istream& stream, size_t max_payload_size);
+};
+} // namespace load_generator
+} // namespace taste
+
+#endif
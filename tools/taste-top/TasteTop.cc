@@ -0,0 +1,291 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    TasteTop.cc
+ * @brief   Live inspector of runtime metrics.
+ *
+ * Usage: taste-top [pid] [interval_ms=1000] [once]
+ *
+ * Attaches to the metrics shared memory segment of the given process
+ * and periodically prints per-queue, per-thread, per-timer and per-lock
+ * statistics. Without pid, lists processes which publish metrics.
+ * The tool shall be built with the same RT_METRICS_* configuration as
+ * the inspected process, which is validated using the block size.
+ */
+
+#include "Metrics.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+using taste::MetricsBlock;
+
+struct Sample
+{
+    uint64_t value;
+    uint64_t cpu_ticks;
+};
+
+/// Previous values of counters, used to compute rates
+std::map<std::string, Sample> previous_samples;
+
+uint64_t
+load(const taste::MetricsCounter& counter)
+{
+    return counter.load(std::memory_order_relaxed);
+}
+
+double
+rate(const std::string& key, uint64_t value, double interval_s)
+{
+    auto it = previous_samples.find(key);
+    const uint64_t previous = it == previous_samples.end() ? value : it->second.value;
+    previous_samples[key].value = value;
+    // the counter restarts when its entry is reused by another queue or lock
+    const uint64_t delta = value >= previous ? value - previous : value;
+    return interval_s > 0.0 ? static_cast<double>(delta) / interval_s : 0.0;
+}
+
+/// Entries are filled in before they are published, so only published entries are shown
+template<typename T>
+bool
+is_active(const T& entry)
+{
+    return entry.state.load(std::memory_order_acquire) == taste::METRICS_ENTRY_ACTIVE;
+}
+
+bool
+read_thread_stat(int pid, int tid, char& state, uint64_t& cpu_ticks)
+{
+    std::ifstream stat_file("/proc/" + std::to_string(pid) + "/task/" + std::to_string(tid) + "/stat");
+    std::string content;
+    if(!std::getline(stat_file, content)) {
+        return false;
+    }
+    // the thread name may contain spaces, fields are counted after it
+    const size_t name_end = content.rfind(')');
+    if(name_end == std::string::npos) {
+        return false;
+    }
+    std::istringstream fields(content.substr(name_end + 2));
+    std::string field;
+    fields >> state;
+    // utime and stime are 14th and 15th fields, state is 3rd
+    for(int i = 4; i < 14; ++i) {
+        fields >> field;
+    }
+    uint64_t user_ticks = 0;
+    uint64_t system_ticks = 0;
+    fields >> user_ticks >> system_ticks;
+    cpu_ticks = user_ticks + system_ticks;
+    return true;
+}
+
+void
+list_processes()
+{
+    const std::string prefix = std::string(RT_METRICS_SHM_PREFIX).substr(1);
+    DIR* directory = opendir("/dev/shm");
+    if(directory == nullptr) {
+        std::cerr << "Unable to open /dev/shm" << std::endl;
+        return;
+    }
+    std::cout << "Processes publishing metrics:" << std::endl;
+    while(const dirent* entry = readdir(directory)) {
+        const std::string name = entry->d_name;
+        if(name.compare(0, prefix.size(), prefix) == 0) {
+            std::cout << "  " << name.substr(prefix.size()) << std::endl;
+        }
+    }
+    closedir(directory);
+}
+
+const MetricsBlock*
+attach(int pid)
+{
+    const std::string name = RT_METRICS_SHM_PREFIX + std::to_string(pid);
+    const int descriptor = shm_open(name.c_str(), O_RDONLY, 0);
+    if(descriptor < 0) {
+        std::cerr << "Unable to open metrics segment '" << name << "'" << std::endl;
+        return nullptr;
+    }
+    struct stat status;
+    if(fstat(descriptor, &status) != 0 || static_cast<size_t>(status.st_size) != sizeof(MetricsBlock)) {
+        std::cerr << "Metrics segment size does not match, rebuild with the same RT_METRICS_* configuration"
+                  << std::endl;
+        close(descriptor);
+        return nullptr;
+    }
+    void* memory = mmap(nullptr, sizeof(MetricsBlock), PROT_READ, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+    if(memory == MAP_FAILED) {
+        std::cerr << "Unable to map metrics segment" << std::endl;
+        return nullptr;
+    }
+
+    const MetricsBlock* block = static_cast<const MetricsBlock*>(memory);
+    if(block->magic != taste::METRICS_MAGIC || block->version != taste::METRICS_VERSION
+       || block->size != sizeof(MetricsBlock)) {
+        std::cerr << "Unsupported metrics block version " << block->version << std::endl;
+        return nullptr;
+    }
+    return block;
+}
+
+void
+print(const MetricsBlock& block, double interval_s)
+{
+    const long ticks_per_second = sysconf(_SC_CLK_TCK);
+    const uint32_t queue_count =
+            std::min<uint32_t>(block.queue_count.load(std::memory_order_acquire), RT_METRICS_MAX_QUEUES);
+    const uint32_t thread_count =
+            std::min<uint32_t>(block.thread_count.load(std::memory_order_acquire), RT_METRICS_MAX_THREADS);
+    const uint32_t timer_count =
+            std::min<uint32_t>(block.timer_count.load(std::memory_order_acquire), RT_METRICS_MAX_TIMERS);
+    const uint32_t lock_count =
+            std::min<uint32_t>(block.lock_count.load(std::memory_order_acquire), RT_METRICS_MAX_LOCKS);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "taste-top - pid " << block.process_id << std::endl << std::endl;
+
+    std::cout << std::left << std::setw(32) << "QUEUE" << std::right << std::setw(8) << "DEPTH" << std::setw(8)
+              << "CAP" << std::setw(8) << "PEAK" << std::setw(12) << "PUT/s" << std::setw(12) << "GET/s"
+              << std::setw(10) << "DROPS" << std::setw(9) << "RESIZES" << std::endl;
+    for(uint32_t i = 0; i < queue_count; ++i) {
+        const taste::QueueMetrics& queue = block.queues[i];
+        if(!is_active(queue)) {
+            continue;
+        }
+        const std::string key = "q" + std::to_string(i);
+        std::cout << std::left << std::setw(32) << queue.name << std::right << std::setw(8) << load(queue.depth)
+                  << std::setw(8) << load(queue.capacity) << std::setw(8) << load(queue.peak_depth) << std::setw(12)
+                  << rate(key + "p", load(queue.puts), interval_s) << std::setw(12)
+                  << rate(key + "g", load(queue.gets), interval_s) << std::setw(10) << load(queue.drops)
+                  << std::setw(9) << load(queue.resizes) << std::endl;
+    }
+
+    std::cout << std::endl
+              << std::left << std::setw(32) << "THREAD" << std::right << std::setw(8) << "TID" << std::setw(6)
+              << "PRIO" << std::setw(12) << "STACK" << std::setw(7) << "STATE" << std::setw(8) << "CPU%"
+              << std::endl;
+    for(uint32_t i = 0; i < thread_count; ++i) {
+        const taste::ThreadMetrics& thread = block.threads[i];
+        if(!is_active(thread)) {
+            continue;
+        }
+        const int tid = thread.thread_id.load(std::memory_order_relaxed);
+        char state = '-';
+        uint64_t cpu_ticks = 0;
+        double cpu_percent = 0.0;
+        if(tid != 0 && read_thread_stat(block.process_id, tid, state, cpu_ticks)) {
+            const double ticks_per_interval = rate("t" + std::to_string(i), cpu_ticks, interval_s);
+            cpu_percent = 100.0 * ticks_per_interval / static_cast<double>(ticks_per_second);
+        }
+        std::cout << std::left << std::setw(32) << thread.name << std::right << std::setw(8) << tid << std::setw(6)
+                  << thread.priority.load(std::memory_order_relaxed) << std::setw(12) << load(thread.stack_size)
+                  << std::setw(7) << state << std::setw(8) << cpu_percent << std::endl;
+    }
+
+    std::cout << std::endl
+              << std::left << std::setw(32) << "TIMER" << std::right << std::setw(12) << "PERIOD_us" << std::setw(12)
+              << "ACT/s" << std::setw(10) << "OVERRUNS" << std::setw(14) << "MAX_LATE_us" << std::endl;
+    for(uint32_t i = 0; i < timer_count; ++i) {
+        const taste::TimerMetrics& timer = block.timers[i];
+        if(!is_active(timer)) {
+            continue;
+        }
+        std::cout << std::left << std::setw(32) << timer.name << std::right << std::setw(12)
+                  << static_cast<double>(load(timer.period_ns)) / 1000.0 << std::setw(12)
+                  << rate("m" + std::to_string(i), load(timer.activations), interval_s) << std::setw(10)
+                  << load(timer.overruns) << std::setw(14) << static_cast<double>(load(timer.max_lateness_ns)) / 1000.0
+                  << std::endl;
+    }
+
+    std::cout << std::endl
+              << std::left << std::setw(32) << "LOCK" << std::right << std::setw(12) << "ACQ/s" << std::setw(12)
+              << "CONTENDED%" << std::setw(14) << "WAIT_us/s" << std::endl;
+    for(uint32_t i = 0; i < lock_count; ++i) {
+        const taste::LockMetrics& lock = block.locks[i];
+        if(!is_active(lock)) {
+            continue;
+        }
+        const std::string key = "l" + std::to_string(i);
+        const double acquisitions = rate(key + "a", load(lock.acquisitions), interval_s);
+        const double contended = rate(key + "c", load(lock.contended_acquisitions), interval_s);
+        const double wait_time = rate(key + "w", load(lock.wait_time_ns), interval_s);
+        std::cout << std::left << std::setw(32) << lock.name << std::right << std::setw(12) << acquisitions
+                  << std::setw(12) << (acquisitions > 0.0 ? 100.0 * contended / acquisitions : 0.0) << std::setw(14)
+                  << wait_time / 1000.0 << std::endl;
+    }
+}
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    if(argc < 2) {
+        list_processes();
+        return EXIT_SUCCESS;
+    }
+
+    const int pid = atoi(argv[1]);
+    const long interval_ms = argc > 2 ? atol(argv[2]) : 1000;
+    const bool once = argc > 3 && strcmp(argv[3], "once") == 0;
+
+    const MetricsBlock* block = attach(pid);
+    if(block == nullptr) {
+        return EXIT_FAILURE;
+    }
+
+    // the first sample initializes the rates
+    print(*block, 0.0);
+    while(!once && kill(pid, 0) == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+        std::cout << "\033[H\033[2J";
+        print(*block, static_cast<double>(interval_ms) / 1000.0);
+        std::cout.flush();
+    }
+    if(once) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+        std::cout << std::endl;
+        print(*block, static_cast<double>(interval_ms) / 1000.0);
+    }
+
+    return EXIT_SUCCESS;
+}